@@ -1,178 +1,239 @@
 #include "Actor.h"
 #include "StudentWorld.h"
 #include "GameConstants.h"
+#include "ActorPool.h"
+#include "AllocStats.h"
 #include <cmath>
+#include <cstdlib>
 
 // Students:  Add code to this file, Actor.h, StudentWorld.h, and StudentWorld.cpp
 
 // Non-member functions
 bool overlap(const Actor* a, const Actor* b)
 {
-	double delX = abs(a->getX() - b->getX());
-	double delY = abs(a->getY() - b->getY());
-	double radSum = a->getRadius() + b->getRadius();
+	return overlap(a->getFixedX(), a->getFixedY(), a->getFixedRadius(), b);
+}
+
+bool overlap(fixed ax, fixed ay, fixed aRadius, const Actor* b)
+{
+	// delX < radSum * 0.25 and delY < radSum * 0.6, in exact integer arithmetic
+	int64_t delX = std::abs(static_cast<int64_t>(ax) - b->getFixedX());
+	int64_t delY = std::abs(static_cast<int64_t>(ay) - b->getFixedY());
+	int64_t radSum = static_cast<int64_t>(aRadius) + b->getFixedRadius();
 
-	if (delX < radSum * 0.25 && delY < radSum * 0.6)
+	if (delX * 4 < radSum && delY * 10 < radSum * 6)
 		return true;
 
 	return false;
 }
 
 
+// size of each image ID's class, for the allocation accounting
+static const int ACTOR_SIZE[] = {
+	sizeof(GhostRacer),		// IID_GHOST_RACER
+	0,						// IID_YELLOW_BORDER_LINE, drawn as part of the road rather than as actors
+	0,						// IID_WHITE_BORDER_LINE
+	sizeof(Oil),			// IID_OIL_SLICK
+	sizeof(Human),			// IID_HUMAN_PED
+	sizeof(Zombie),			// IID_ZOMBIE_PED
+	sizeof(Cab),			// IID_ZOMBIE_CAB
+	sizeof(Spray),			// IID_HOLY_WATER_PROJECTILE
+	sizeof(Heal),			// IID_HEAL_GOODIE
+	sizeof(Soul),			// IID_SOUL_GOODIE
+	sizeof(HolyWater)		// IID_HOLY_WATER_GOODIE
+};
+
 // Actor definitions
 Actor::Actor(int imageID, double startX, double startY, int dir, double size, unsigned int depth, 
-	double speedX, double speedY, int hp, bool alive, bool collidable, StudentWorld* world)
-	: GraphObject(imageID, startX, startY, dir, size, depth), m_speedX(speedX), m_speedY(speedY), 
-	m_hp(hp), m_alive(alive), m_collidable(collidable), m_world(world) {}
+	double speedX, double speedY, int hp, bool alive)
+	: GraphObject(imageID, startX, startY, dir, size, depth), m_motionSlot(-1), m_deathCause(DEATH_DAMAGE) {
+	m_state.speedX = toFixed(speedX);
+	m_state.speedY = toFixed(speedY);
+	m_state.hp = static_cast<int16_t>(hp);
+	if (alive)
+		m_state.flags |= STATE_ALIVE;
+	allocStats().actorCreated(imageID, ACTOR_SIZE[imageID]);
+}
+
+Actor::~Actor() {
+	allocStats().actorDestroyed(getImageID());
+}
+
+void* Actor::operator new(size_t size) {
+	return ActorPool::allocate(size);
+}
 
-Actor::~Actor() {}
+void Actor::operator delete(void* p, size_t size) {
+	ActorPool::deallocate(p, size);
+}
 
-void Actor::doSomething() {
-	double newX, newY;
-	newY = getY() + m_speedY - getWorld()->getRacer()->getSpeedY();
-	newX = getX() + m_speedX;
-	GraphObject::moveTo(newX, newY);
+void Actor::doSomething(StudentWorld& world) {
+	fixed newX, newY;
+	newY = getFixedY() + m_state.speedY - world.getRacer()->getFixedSpeedY();
+	newX = getFixedX() + m_state.speedX;
+	GraphObject::moveToFixed(newX, newY);
 
 	checkInBounds();
 }
 
 // setters
-void Actor::damage(int dmg) {
-	m_hp -= dmg;
+void Actor::damage(int dmg, StudentWorld& world) {
+	takeDamage(dmg, SOUND_NONE, SOUND_NONE, world);
+}
+
+void Actor::takeDamage(int dmg, int hurtSound, int dieSound, StudentWorld& world) {
+	m_state.hp = static_cast<int16_t>(m_state.hp - dmg);
+	world.logEvent(GAMEPLAY_DAMAGE, this, dmg);
 
-	if (m_hp <= 0) {
-		kill();
-		if (dieSound() != -1) {
-			getWorld()->playSound(dieSound());
+	if (m_state.hp <= 0) {
+		kill(DEATH_DAMAGE);
+		if (dieSound != SOUND_NONE) {
+			world.events().sound(dieSound);
 		}
 	}
 	else {
-		if (hurtSound() != -1) {
-			getWorld()->playSound(hurtSound());
+		if (hurtSound != SOUND_NONE) {
+			world.events().sound(hurtSound);
 		}
 	}
 }
 
-void Actor::kill() {
-	m_alive = false;
+void Actor::kill(DeathCause cause) {
+	m_state.flags &= ~STATE_ALIVE;
+	m_deathCause = cause;
+}
+
+void Actor::revive(int hp) {
+	m_state.flags |= STATE_ALIVE;
+	m_state.hp = static_cast<int16_t>(hp);
 }
 
 void Actor::setSpeedX(double speed) {
-	m_speedX = speed;
+	m_state.speedX = toFixed(speed);
 }
 
 void Actor::setSpeedY(double speed) {
-	m_speedY = speed;
+	m_state.speedY = toFixed(speed);
 }
 
 void Actor::checkInBounds() {
-	if (getX() < 0 || getY() < 0 || getX() > VIEW_WIDTH || getY() > VIEW_HEIGHT)
-		kill();
+	if (getFixedX() < 0 || getFixedY() < 0 || getFixedX() > VIEW_WIDTH * FIXED_ONE || getFixedY() > VIEW_HEIGHT * FIXED_ONE)
+		kill(DEATH_OFF_SCREEN);
 }
 
 // getters
 double Actor::getSpeedX() const {
-	return m_speedX;
+	return fromFixed(m_state.speedX);
 }
 
 double Actor::getSpeedY() const {
-	return m_speedY;
+	return fromFixed(m_state.speedY);
+}
+
+fixed Actor::getFixedSpeedX() const {
+	return m_state.speedX;
+}
+
+fixed Actor::getFixedSpeedY() const {
+	return m_state.speedY;
 }
 
 int Actor::getHP() const {
-	return m_hp;
+	return m_state.hp;
 }
 
-bool Actor::alive() const {
-	return m_alive;
+int Actor::getImageID() const {
+	return m_state.imageID;
 }
 
-bool Actor::collidable() const {
-	return m_collidable;
+bool Actor::alive() const {
+	return (m_state.flags & STATE_ALIVE) != 0;
 }
 
-StudentWorld* Actor::getWorld() const {
-	return m_world;
+DeathCause Actor::getDeathCause() const {
+	return m_deathCause;
 }
 
-int Actor::hurtSound() const {
-	return -1;
+template <class T>
+bool Actor::touchingRacer(const T* self, const StudentWorld& world) const {
+	return collides(ActorTraits<T>::category, CAT_RACER) && overlap(self, world.getRacer());
 }
 
-int Actor::dieSound() const {
-	return -1;
+int Actor::getMotionSlot() const {
+	return m_motionSlot;
 }
 
-bool Actor::sprayable() const {
-	return false;
+void Actor::setMotionSlot(int slot) {
+	m_motionSlot = slot;
 }
 
 
 // GhostRacer definitions
-GhostRacer::GhostRacer(StudentWorld* world)
-	: Actor(IID_GHOST_RACER, 128, 32, 90, 4.0, 0, 0, 0, 100, true, true, world), m_sprays(10) {}
+GhostRacer::GhostRacer()
+	: Actor(IID_GHOST_RACER, 128, 32, 90, 4.0, 0, 0, 0, RACER_MAX_HP, true), m_sprays(10) {}
 
 GhostRacer::~GhostRacer() {}
 
-void GhostRacer::doSomething() {
+void GhostRacer::doSomething(StudentWorld& world) {
 	int ch;
 	if (getX() <= LEFT_BOUND) {			// left
 		if (getDirection() > 90) {
-			damage(10);
+			damage(10, world);
 		}
 
 		setDirection(82);
-		getWorld()->playSound(SOUND_VEHICLE_CRASH);
+		world.events().sound(SOUND_VEHICLE_CRASH);
 	}
 	else if (getX() >= RIGHT_BOUND) {	// right
 		if (getDirection() < 90) {
-			damage(10);
+			damage(10, world);
 		}
 
 		setDirection(98);
-		getWorld()->playSound(SOUND_VEHICLE_CRASH);
+		world.events().sound(SOUND_VEHICLE_CRASH);
 	}
-	else if (getWorld()->getKey(ch))
+	else
 	{
-		// user hit a key during this tick!
-		switch (ch)
+		// every key the user hit that this tick takes, in the order they were hit
+		while (world.getInput(ch))
 		{
-		case KEY_PRESS_LEFT:
-			if (getDirection() < 114)
-				setDirection(getDirection() + 8);
-			break;
-		case KEY_PRESS_RIGHT:
-			if (getDirection() > 66)
-				setDirection(getDirection() - 8);
-			break;
-		case KEY_PRESS_UP:
-			if (getSpeedY() < 5)
-				setSpeedY(getSpeedY() + 1);
-			break;
-		case KEY_PRESS_DOWN:
-			if (getSpeedY() > -1)
-				setSpeedY(getSpeedY() - 1);
-			break;
-		case KEY_PRESS_SPACE:
-			if (m_sprays > 0) {
-				double currDir = getDirection() * 1.0 / 180 * 4 * atan(1.0);
-				getWorld()->addActor(new Spray(getX() + SPRITE_HEIGHT * cos(currDir), 
-					getY() + SPRITE_HEIGHT * sin(currDir), getDirection(), getWorld()));
-				getWorld()->playSound(SOUND_PLAYER_SPRAY);
-				--m_sprays;
+			switch (ch)
+			{
+			case KEY_PRESS_LEFT:
+				if (getDirection() < 114)
+					setDirection(getDirection() + 8);
+				break;
+			case KEY_PRESS_RIGHT:
+				if (getDirection() > 66)
+					setDirection(getDirection() - 8);
+				break;
+			case KEY_PRESS_UP:
+				if (getSpeedY() < 5)
+					setSpeedY(getSpeedY() + 1);
+				break;
+			case KEY_PRESS_DOWN:
+				if (getSpeedY() > -1)
+					setSpeedY(getSpeedY() - 1);
+				break;
+			case KEY_PRESS_SPACE:
+				if (m_sprays > 0) {
+					world.events().spawn(new Spray(fromFixed(getFixedX() + SPRITE_HEIGHT * fixedCos(getDirection())),
+						fromFixed(getFixedY() + SPRITE_HEIGHT * fixedSin(getDirection())), getDirection()));
+					world.events().sound(SOUND_PLAYER_SPRAY);
+					--m_sprays;
+				}
+				break;
 			}
-			break;
 		}
 	}
 
-	double maxShift = 4.0;
-	double dir = getDirection() * 1.0 / 180 * 4 * atan(1.0);
-	double delX = cos(dir) * maxShift;
-	moveTo(getX() + delX, getY());
+	int maxShift = 4;
+	fixed delX = fixedCos(getDirection()) * maxShift;
+	moveToFixed(getFixedX() + delX, getFixedY());
 }
 
-int GhostRacer::dieSound() const {
-	return SOUND_PLAYER_DIE;
+void GhostRacer::damage(int dmg, StudentWorld& world) {
+	takeDamage(dmg, ActorTraits<GhostRacer>::hurtSound, ActorTraits<GhostRacer>::dieSound, world);
 }
 
 int GhostRacer::getSprays()
@@ -185,21 +246,14 @@ void GhostRacer::setSprays(int sprays) {
 }
 
 
-// BorderLine definitions
-BorderLine::BorderLine(int imageID, double startX, double startY, StudentWorld* world)
-	: Actor(imageID, startX, startY, 0, 2.0, 2, 0, -4, 0, true, false, world) {}
-
-BorderLine::~BorderLine() {}
-
-
 // Agent definitions
 Agent::Agent(int imageID, double startX, double startY, int dir, double size, unsigned int depth, 
-	double speedY, int hp, StudentWorld* world)
-	: Actor(imageID, startX, startY, dir, size, depth, 0, speedY, hp, true, true, world), m_plan(0) {}
+	double speedY, int hp)
+	: Actor(imageID, startX, startY, dir, size, depth, 0, speedY, hp, true), m_plan(0) {}
 
 Agent::~Agent() {}
 
-void Agent::doSomething() {
+void Agent::doSomething(StudentWorld& /* world */) {
 	if (m_plan > 0) {
 		--m_plan;
 	}
@@ -215,20 +269,16 @@ int Agent::getPlanLength() const {
 	return m_plan;
 }
 
-bool Agent::sprayable() const {
-	return true;
-}
-
 
 // Pedestrian definitions
-Pedestrian::Pedestrian(int imageID, double startX, double startY, double size, StudentWorld* world)
-	: Agent(imageID, startX, startY, 0, size, 0, -4, 2, world) {}
+Pedestrian::Pedestrian(int imageID, double startX, double startY, double size)
+	: Agent(imageID, startX, startY, 0, size, 0, -4, 2) {}
 
 Pedestrian::~Pedestrian() {}
 
-void Pedestrian::doSomething() {
-	Actor::doSomething();
-	Agent::doSomething();
+void Pedestrian::doSomething(StudentWorld& world) {
+	Actor::doSomething(world);
+	Agent::doSomething(world);
 
 	if (getPlanLength() == 0) {
 		resetPlanLength();
@@ -245,32 +295,24 @@ void Pedestrian::doSomething() {
 	}
 }
 
-int Pedestrian::hurtSound() const {
-	return SOUND_PED_HURT;
-}
-
-int Pedestrian::dieSound() const {
-	return SOUND_PED_DIE;
-}
-
 
 // Human definitions
-Human::Human(double startX, double startY, StudentWorld* world)
-	: Pedestrian(IID_HUMAN_PED, startX, startY, 2.0, world) {}
+Human::Human(double startX, double startY)
+	: Pedestrian(IID_HUMAN_PED, startX, startY, 2.0) {}
 
 Human::~Human() {}
 
-void Human::doSomething() {
-	if (overlap(this, getWorld()->getRacer())) {
-		getWorld()->getRacer()->kill();
+void Human::doSomething(StudentWorld& world) {
+	if (touchingRacer(this, world)) {
+		world.events().kill(world.getRacer());
 		return;
 	}
 
-	Pedestrian::doSomething();
+	Pedestrian::doSomething(world);
 }
 
-void Human::damage(int dmg) {
-	Actor::damage(0);	// human can't be damaged/killed
+void Human::damage(int /* dmg */, StudentWorld& world) {
+	takeDamage(0, ActorTraits<Human>::hurtSound, ActorTraits<Human>::dieSound, world);	// human can't be damaged/killed
 
 	setSpeedX(getSpeedX() * -1);
 	setDirection(getDirection() - 180); // don't have to worry about negative, auto set in GraphObject.h
@@ -278,61 +320,62 @@ void Human::damage(int dmg) {
 
 
 // Zombie definitions
-Zombie::Zombie(double startX, double startY, StudentWorld* world)
-	: Pedestrian(IID_ZOMBIE_PED, startX, startY, 3.0, world), m_gruntTicks(0), m_racer(world->getRacer()) {}
+Zombie::Zombie(double startX, double startY)
+	: Pedestrian(IID_ZOMBIE_PED, startX, startY, 3.0), m_gruntTicks(0) {}
 
-Zombie::~Zombie() {} // don't need to delete m_racer since StudentWorld does that
+Zombie::~Zombie() {}
 
-void Zombie::doSomething() {
-	if (overlap(this, m_racer)) {
-		m_racer->damage(5);
-		damage(2);
+void Zombie::doSomething(StudentWorld& world) {
+	GhostRacer* racer = world.getRacer();
+	if (touchingRacer(this, world)) {
+		world.events().damage(racer, 5);
+		damage(2, world);
 	}
 
-	if (abs(getX() - m_racer->getX()) <= 30 && getY() > m_racer->getY()) {
+	if (abs(getX() - racer->getX()) <= 30 && getY() > racer->getY()) {
 		setDirection(270);
-		if (getX() < m_racer->getX())		// to the left of racer
+		if (getX() < racer->getX())		// to the left of racer
 			setSpeedX(1);
-		else if (getX() > m_racer->getX())	// to the right of racer
+		else if (getX() > racer->getX())	// to the right of racer
 			setSpeedX(-1);
 		else								// same x coordinate
 			setSpeedX(0);
 
 		--m_gruntTicks;
 		if (m_gruntTicks <= 0) {
-			getWorld()->playSound(SOUND_ZOMBIE_ATTACK);
+			world.events().sound(SOUND_ZOMBIE_ATTACK);
 			m_gruntTicks = 20;
 		}
 	}
 
-	Pedestrian::doSomething();
+	Pedestrian::doSomething(world);
 }
 
-void Zombie::damage(int dmg) {
-	Actor::damage(dmg);
+void Zombie::damage(int dmg, StudentWorld& world) {
+	takeDamage(dmg, ActorTraits<Zombie>::hurtSound, ActorTraits<Zombie>::dieSound, world);
 
 	if (getHP() <= 0) {
-		if (!overlap(this, m_racer)) {
-			if (randInt(1, 5) == 1) {
-				getWorld()->addActor(new Heal(getX(), getY(), getWorld()));
+		if (!touchingRacer(this, world)) {
+			if (randInt(1, world.getLevelDef().healDropChance) == 1) {
+				world.events().spawn(new Heal(getX(), getY()));
 			}
 		}
 
-		getWorld()->increaseScore(150);
+		world.events().score(150);
 	}
 }
 
 // Zombie Cab definitions
-Cab::Cab(double startX, double startY, double speedY, int lane, StudentWorld* world)
-	: Agent(IID_ZOMBIE_CAB, startX, startY, 90, 4.0, 0, speedY, 3, world), m_damagedRacer(false), m_lane(lane) {}
+Cab::Cab(double startX, double startY, double speedY, int lane)
+	: Agent(IID_ZOMBIE_CAB, startX, startY, 90, 4.0, 0, speedY, 3), m_damagedRacer(false), m_lane(lane) {}
 
 Cab::~Cab() {}
 
-void Cab::doSomething() {
-	GhostRacer* racer = getWorld()->getRacer();
-	if (overlap(this, racer) && !m_damagedRacer) {
-		getWorld()->playSound(SOUND_VEHICLE_CRASH);
-		racer->damage(20);
+void Cab::doSomething(StudentWorld& world) {
+	GhostRacer* racer = world.getRacer();
+	if (touchingRacer(this, world) && !m_damagedRacer) {
+		world.events().sound(SOUND_VEHICLE_CRASH);
+		world.events().damage(racer, 20);
 
 		if (getX() - racer->getX() <= 0) {
 			setSpeedX(-5);
@@ -346,20 +389,20 @@ void Cab::doSomething() {
 		m_damagedRacer = true;
 	}
 
-	Actor::doSomething();
+	Actor::doSomething(world);
 
 	// check actors if in front or behind cab
-	if (getSpeedY() > racer->getSpeedY() && getWorld()->checkCabFrontOrBack(m_lane, this) == 0) {
+	if (getSpeedY() > racer->getSpeedY() && world.checkCabFrontOrBack(m_lane, this) == 0) {
 		setSpeedY(getSpeedY() - 0.5);
 		return;
 	}
-	if (getSpeedY() <= racer->getSpeedY() && getWorld()->checkCabFrontOrBack(m_lane, this) == 1) {
+	if (getSpeedY() <= racer->getSpeedY() && world.checkCabFrontOrBack(m_lane, this) == 1) {
 		setSpeedY(getSpeedY() + 0.5);
 		return;
 	}
 
 	// decrement plan distance
-	Agent::doSomething();
+	Agent::doSomething(world);
 
 	if (getPlanLength() == 0) {
 		resetPlanLength();
@@ -368,183 +411,134 @@ void Cab::doSomething() {
 	}
 }
 
-void Cab::damage(int dmg) {
-	Actor::damage(dmg);
+void Cab::damage(int dmg, StudentWorld& world) {
+	takeDamage(dmg, ActorTraits<Cab>::hurtSound, ActorTraits<Cab>::dieSound, world);
 
 	if (getHP() <= 0) {
-		if (randInt(1, 5) == 1) {
-			getWorld()->addActor(new Oil(getX(), getY(), getWorld()));
+		if (randInt(1, world.getLevelDef().oilDropChance) == 1) {
+			world.events().spawn(new Oil(getX(), getY()));
 		}
 
-		getWorld()->increaseScore(200);
+		world.events().score(200);
 	}
 }
 
-int Cab::hurtSound() const {
-	return SOUND_VEHICLE_HURT;
-}
-
-int Cab::dieSound() const {
-	return SOUND_VEHICLE_DIE;
-}
-
 
 // Goodie definitions
-Goodie::Goodie(int imageID, double startX, double startY, int dir, double size, StudentWorld* world)
-	: Actor(imageID, startX, startY, dir, size, 2, 0, -4, 0, true, false, world) {}
+Goodie::Goodie(int imageID, double startX, double startY, int dir, double size)
+	: Actor(imageID, startX, startY, dir, size, 2, 0, -4, 0, true) {}
 
 Goodie::~Goodie() {}
 
-void Goodie::doSomething() {
-	Actor::doSomething();
-
-	if (overlap(this, getWorld()->getRacer())) {
-		getWorld()->playSound(getSound());
-		doActivity();
-		if (destructible()) {
-			kill();
-		}
-		getWorld()->increaseScore(getScoreIncrease());
+template <class G>
+void Goodie::collect(G* goodie, StudentWorld& world) {
+	world.events().sound(ActorTraits<G>::goodieSound);
+	goodie->doActivity(world);
+	if (ActorTraits<G>::destructible) {
+		kill(DEATH_USED_UP);
 	}
-}
-
-int Goodie::getSound() const {
-	return SOUND_GOT_GOODIE;
-}
-
-bool Goodie::destructible() const {
-	return true;
-}
-
-bool Goodie::sprayable() const {
-	return true;
+	world.events().score(ActorTraits<G>::scoreIncrease);
 }
 
 
 // Oil Slick definitions
-Oil::Oil(double startX, double startY, StudentWorld* world)
-	: Goodie(IID_OIL_SLICK, startX, startY, 0, randInt(2, 5), world) {}
+Oil::Oil(double startX, double startY)
+	: Goodie(IID_OIL_SLICK, startX, startY, 0, randInt(2, 5)) {}
 
 Oil::~Oil() {}
 
-void Oil::doActivity() {
+void Oil::doSomething(StudentWorld& world) {
+	collect(this, world);
+}
+
+void Oil::doActivity(StudentWorld& world) {
 	// spin Ghost Racer
-	GhostRacer* racer = getWorld()->getRacer();
-	int dir = racer->getDirection();
+	int dir = world.getRacer()->getDirection();
 	int cw = randInt(0, 1);
 	if (dir <= 100 && dir >= 80) {
 		if (cw == 0) {
 			// counter clockwise
-			racer->setDirection(dir + randInt(5, 20));
+			world.events().spin(randInt(5, 20));
 		}
 		else {
 			// clockwise
-			racer->setDirection(dir - randInt(5, 20));
+			world.events().spin(-randInt(5, 20));
 		}
 	}
 	else if (dir <= 100) {
-		racer->setDirection(dir + randInt(5, 20));
+		world.events().spin(randInt(5, 20));
 	}
 	else {
-		racer->setDirection(dir - randInt(5, 20));
+		world.events().spin(-randInt(5, 20));
 	}
 }
 
-int Oil::getScoreIncrease() const {
-	return 0;
-}
-
-int Oil::getSound() const {
-	return SOUND_OIL_SLICK;
-}
-
-bool Oil::destructible() const {
-	return false;
-}
-
-bool Oil::sprayable() const {
-	return false;
-}
-
 
 // Healing Goodie definitions
-Heal::Heal(double startX, double startY, StudentWorld* world) 
-	: Goodie(IID_HEAL_GOODIE, startX, startY, 0, 1.0, world) {}
+Heal::Heal(double startX, double startY) 
+	: Goodie(IID_HEAL_GOODIE, startX, startY, 0, 1.0) {}
 
 Heal::~Heal() {}
 
-void Heal::doActivity() {
-	if (getWorld()->getRacer()->getHP() < 90)
-		getWorld()->getRacer()->damage(-10); // damage by -10 = heal by 10
-	else
-		getWorld()->getRacer()->damage(getWorld()->getRacer()->getHP() - 100);
-		// damage by HP - 100 so that it always ends up at 100 when HP >= 90
+void Heal::doSomething(StudentWorld& world) {
+	collect(this, world);
 }
 
-int Heal::getScoreIncrease() const {
-	return 250;
+void Heal::doActivity(StudentWorld& world) {
+	// capped when applied, against the racer's HP after whatever else this tick did to it
+	world.events().heal(10);
 }
 
 
 // Holy Water Goodie definitions
-HolyWater::HolyWater(double startX, double startY, StudentWorld* world)
-	: Goodie(IID_HOLY_WATER_GOODIE, startX, startY, 90, 2.0, world) {}
+HolyWater::HolyWater(double startX, double startY)
+	: Goodie(IID_HOLY_WATER_GOODIE, startX, startY, 90, 2.0) {}
 
 HolyWater::~HolyWater() {}
 
-void HolyWater::doActivity() {
-	getWorld()->getRacer()->setSprays(getWorld()->getRacer()->getSprays() + 10);
+void HolyWater::doSomething(StudentWorld& world) {
+	collect(this, world);
 }
 
-int HolyWater::getScoreIncrease() const {
-	return 50;
+void HolyWater::doActivity(StudentWorld& world) {
+	world.events().sprays(10);
 }
 
 
 // Lost Soul Goodie definitions
-Soul::Soul(double startX, double startY, StudentWorld* world)
-	: Goodie(IID_SOUL_GOODIE, startX, startY, 0, 4.0, world) {}
+Soul::Soul(double startX, double startY)
+	: Goodie(IID_SOUL_GOODIE, startX, startY, 0, 4.0) {}
 
 Soul::~Soul() {}
 
-void Soul::doSomething() {
-	Goodie::doSomething();
-
-	setDirection(getDirection() - 10);
-}
-
-void Soul::doActivity() {
-	getWorld()->savedSoul();
+void Soul::doSomething(StudentWorld& world) {
+	collect(this, world);
 }
 
-int Soul::getSound() const {
-	return SOUND_GOT_SOUL;
-}
-
-int Soul::getScoreIncrease() const {
-	return 100;
+void Soul::spin() {
+	setDirection(getDirection() - 10);
 }
 
-bool Soul::sprayable() const {
-	return false;
+void Soul::doActivity(StudentWorld& world) {
+	world.events().soulSaved();
 }
 
 
 // Holy Water Projectile definitions
-Spray::Spray(double startX, double startY, int dir, StudentWorld* world)
-	: Actor(IID_HOLY_WATER_PROJECTILE, startX, startY, dir, 1.0, 1, 0, 0, 0, true, false, world), m_travelDist(160) {}
+Spray::Spray(double startX, double startY, int dir)
+	: Actor(IID_HOLY_WATER_PROJECTILE, startX, startY, dir, 1.0, 1, 0, 0, 0, true), m_travelDist(160) {}
 
 Spray::~Spray() {}
 
-void Spray::doSomething() {
+void Spray::doSomething(StudentWorld& world) {
 	// check if activated
-	if (!getWorld()->activatedSpray(this)) {
+	if (!world.activatedSpray(this)) {
 		moveForward(SPRITE_HEIGHT);
 		m_travelDist -= SPRITE_HEIGHT;
 		checkInBounds();
 
 		// dissipate if moved a total of 160 pixels
 		if (m_travelDist <= 0)
-			kill();
+			kill(DEATH_USED_UP);
 	}
 }
@@ -2,6 +2,9 @@
 #define ACTOR_H_
 
 #include "GraphObject.h"
+#include "GameConstants.h"
+#include "Collision.h"
+#include <cstddef>
 
 // Students:  Add code to this file, Actor.cpp, StudentWorld.h, and StudentWorld.cpp
 
@@ -9,97 +12,113 @@
 const int LEFT_LANE = 0;
 const int MIDDLE_LANE = 1;
 const int RIGHT_LANE = 2;
+const int RACER_MAX_HP = 100;	// what the racer starts with, and the most healing brings it back to
 
 class StudentWorld;
 
+// why an actor died, logged as the value of its GAMEPLAY_DEATH record
+enum DeathCause {
+	DEATH_DAMAGE,		// damage took its hp to 0
+	DEATH_HIT,			// killed outright, as the racer is by hitting a Human
+	DEATH_OFF_SCREEN,
+	DEATH_USED_UP		// a Goodie collected, or a spray that hit something or went as far as it goes
+};
+
 // Actor base class, derived from GraphObject
+// speed, hp and the alive flag live in GraphObject's hot ActorState, next to the position
+// actors don't keep a pointer to their world, it's passed to each call that needs it
 class Actor : public GraphObject {
 public:
 	Actor(int imageID, double startX, double startY, int dir, double size, unsigned int depth, 
-		double speedX, double speedY, int hp, bool alive, bool collidable, StudentWorld* world);
+		double speedX, double speedY, int hp, bool alive);
 	virtual ~Actor();
 
+	// actors are allocated from ActorPool
+	static void* operator new(std::size_t size);
+	static void operator delete(void* p, std::size_t size);
+
 	// by default does the movement algorithm that all but GhostRacer and Spray use
-	virtual void doSomething();
+	virtual void doSomething(StudentWorld& world);
 	
 	// public setters
-	// damages current actor, and plays appropriate hurt/death sounds if necessary
+	// damages current actor, with no hurt/death sounds by default
 	// also functions as the reaction to sprays in derived classes
-	virtual void damage(int dmg);
+	virtual void damage(int dmg, StudentWorld& world);
+
+	// sets alive to false, remembering why for the gameplay log
+	void kill(DeathCause cause);
 
-	// sets alive to false
-	void kill();
+	// brings a killed actor back with hp health, used by stress scenarios to keep the racer in play
+	void revive(int hp);
 	
 	// public getters
 	double getSpeedX() const;
 	double getSpeedY() const;
+	fixed getFixedSpeedX() const;
+	fixed getFixedSpeedY() const;
 	int getHP() const;
+	int getImageID() const;
 	bool alive() const;
-	bool collidable() const;
+	DeathCause getDeathCause() const;
 
-	// sprayable is false by default
-	virtual bool sprayable() const;
+	// index into StudentWorld's MotionKernel, or -1 if this actor moves itself
+	int getMotionSlot() const;
+	void setMotionSlot(int slot);
 
 protected:
 	void setSpeedX(double speed);
 	void setSpeedY(double speed);
-	StudentWorld* getWorld() const;
 
-	// check if actor is in bounds, and kill() if it is not
+	// check if actor is in bounds, and kill() it if it is not
 	void checkInBounds();
 
+	// damages current actor, and plays hurtSound or dieSound accordingly unless it is SOUND_NONE
+	// derived classes' damage() pass in the sounds from their ActorTraits
+	void takeDamage(int dmg, int hurtSound, int dieSound, StudentWorld& world);
+
+	// true if self, this actor as its concrete type T, overlaps the racer
+	// never tests the overlap if T's category can't interact with the racer
+	template <class T>
+	bool touchingRacer(const T* self, const StudentWorld& world) const;
+
 private:
-	// both default to -1, indicating no sound to be played
-	// otherwise returns the appropriate sound to be played when hurt or killed via damage()
-	virtual int hurtSound() const;
-	virtual int dieSound() const;
-
-	double m_speedX;
-	double m_speedY;
-	int m_hp;
-	bool m_alive;
-	bool m_collidable;
-
-	StudentWorld* m_world;
+	int m_motionSlot;
+	DeathCause m_deathCause;
 };
 
+// Per-type constants, looked up at compile time instead of through virtual functions
+// specialized for each concrete actor class below
+template <class T>
+struct ActorTraits;
+
 // GhostRacer, derived from Actor
-class GhostRacer : public Actor {
+class GhostRacer final : public Actor {
 public:
-	GhostRacer(StudentWorld* world);
+	GhostRacer();
 	virtual ~GhostRacer();
 
 	// checks if it hits the borders, else if you hit a key, else move accordingly
-	virtual void doSomething();
+	virtual void doSomething(StudentWorld& world);
+
+	// damages racer, playing SOUND_PLAYER_DIE if it dies
+	virtual void damage(int dmg, StudentWorld& world);
 
 	int getSprays();
 	void setSprays(int sprays);
 
 private:
-	virtual int dieSound() const;
-
 	int m_sprays;
 };
 
-// BorderLine, derived from Actor
-class BorderLine : public Actor {
-public:
-	BorderLine(int imageID, double startX, double startY, StudentWorld* world);
-	virtual ~BorderLine();
-};
-
 // Agent, derived from Actor, base for Pedestrians/Zombie Cabs
 class Agent : public Actor {
 public:
 	Agent(int imageID, double startX, double startY, int dir, double size, unsigned int depth, 
-		double speedY, int hp, StudentWorld* world);
+		double speedY, int hp);
 	virtual ~Agent();
 
 	// runs the commonality between all Agents, namely decrementing plan length if necessary
-	virtual void doSomething();
-
-	// all Agents are sprayable, so this returns true
-	virtual bool sprayable() const;
+	virtual void doSomething(StudentWorld& world);
 
 protected:
 	// setters
@@ -116,82 +135,70 @@ private:
 // Pedestrian, derived from Agent, base for Human/Zombie
 class Pedestrian : public Agent {
 public:
-	Pedestrian(int imageID, double startX, double startY, double size, StudentWorld* world);
+	Pedestrian(int imageID, double startX, double startY, double size);
 	virtual ~Pedestrian();
 
 	// calls Actor's doSomething() for movement, then Agent's doSomething() to decrement plan
 	// then runs common function between Human and Zombie, namely resetting plan length and changing
 	// horizontal speed and direction accordingly
-	virtual void doSomething();
-
-private:
-	virtual int hurtSound() const;
-	virtual int dieSound() const;
+	virtual void doSomething(StudentWorld& world);
 };
 
 // Human, derived from Pedestrian
-class Human : public Pedestrian {
+class Human final : public Pedestrian {
 public:
-	Human(double startX, double startY, StudentWorld* world);
+	Human(double startX, double startY);
 	virtual ~Human();
 
 	// kill racer if overlap
 	// then calls Pedestrian's doSomething(), for the common functionality between Humans and Zombies
-	virtual void doSomething();
+	virtual void doSomething(StudentWorld& world);
 
 	// damage is used ONLY by spray, as spray functionality works in the same way
 	// Human CANNOT be damaged, and thus calls Actor's damage with a damage of 0 every time
 	// and then does its spray reaction, namely changing direction and horizontal speed
-	virtual void damage(int dmg);
+	virtual void damage(int dmg, StudentWorld& world);
 };
 
 // Zombie, derived from Pedestrian
-class Zombie : public Pedestrian {
+class Zombie final : public Pedestrian {
 public:
-	Zombie(double startX, double startY, StudentWorld* world);
+	Zombie(double startX, double startY);
 	virtual ~Zombie();
 
 	// does appropriate damage if overlaps with racer, otherwise sets the proper movement
 	// and plays SOUND_ZOMBIE_ATTACK if honing in on racer
 	// then calls Pedestrian's doSomething(), for the common functionality between Humans and Zombies
-	virtual void doSomething();
+	virtual void doSomething(StudentWorld& world);
 
 	// damage is used by spray as spray functionality works in the same way, AS WELL as when Racer hits Zombie,
 	// calls Actor's damage for the damage dealt by a spray or collision, and then has a 1 in 5 chance to drop
 	// a healing goodie if killed by a spray (not overlapping with GhostRacer)
 	// then increases score by 150
-	virtual void damage(int dmg);
+	virtual void damage(int dmg, StudentWorld& world);
 
 private:
 	int m_gruntTicks;
-
-	// racer member variable kept here and taken from StudentWorld in order to make
-	// calls to racer in both damage() and doSomething() less verbose
-	// m_racer is NOT destructed in Zombie, as it will be destructed in StudentWorld instead
-	GhostRacer* m_racer;
 };
 
 // Zombie Cab, derived from Agent
-class Cab : public Agent {
+class Cab final : public Agent {
 public:
-	Cab(double startX, double startY, double speedY, int lane, StudentWorld* world);
+	Cab(double startX, double startY, double speedY, int lane);
 	virtual ~Cab();
 
 	// damages GhostRacer if overlapping and plays sound accordingly, then no longer damages racer and flies off screen accordingly
 	// if not overlapping, it calls Actor's doSomething() to move accordingly
 	// then checks for collision avoidance-worthy actors in front or behind by 96 pixels in its lane and changes vertical speed accordingly
 	// otherwise call Agent's doSomething to decrement plan distance and resets accordingly if necessary
-	virtual void doSomething();
+	virtual void doSomething(StudentWorld& world);
 
 	// damage is used ONLY by spray, as spray functionality works in the same way
 	// gets damaged by calling Actor's damage, then if killed by spray has 1 in 5 chance of dropping Oil Slick
 	// then increases score by 200
-	virtual void damage(int dmg);
+	virtual void damage(int dmg, StudentWorld& world);
 
 private:
-	virtual int hurtSound() const;
-	virtual int dieSound() const;
-
 	bool m_damagedRacer;
 	int m_lane;
 };
@@ -199,116 +206,162 @@ private:
 // Goodie, derived from Actor, base for Oil Slick/Goodies
 class Goodie : public Actor {
 public:
-	Goodie(int imageID, double startX, double startY, int dir, double size, StudentWorld* world);
+	Goodie(int imageID, double startX, double startY, int dir, double size);
 	virtual ~Goodie();
 
-	// calls Actor's doSomething to move accordingly
-	// then runs common functionality of all Goodies, by playing the appropriate sound if overlapping with racer,
+protected:
+	// Goodies are moved by StudentWorld's MotionKernel, which also finds those touching the racer, and only those
+	// have doSomething() called
+	// runs common functionality of all Goodies, by playing the appropriate sound,
 	// doing the Goodie's common activity, destroying the Goodie, and increasing score accordingly
-	virtual void doSomething();
-	
-	// goodies except Oil Slick and Lost Souls are sprayable by default, so this is set to true
-	virtual bool sprayable() const;
-
-private:
-	// runs each Goodie's unique activity
-	virtual void doActivity() = 0;
-
-	// returns each Goodie's score increase
-	virtual int getScoreIncrease() const = 0;
-
-	// returns each Goodie's collision sound
-	virtual int getSound() const;
-
-	// all goodies except Oil Slick are destructible by default, so this is set to true
-	virtual bool destructible() const;
+	// G is the concrete Goodie, whose doActivity() and ActorTraits are called directly
+	template <class G>
+	void collect(G* goodie, StudentWorld& world);
 };
 
 // Oil Slick, derived from Goodie
-class Oil : public Goodie {
+class Oil final : public Goodie {
 public:
-	Oil(double startX, double startY, StudentWorld* world);
+	Oil(double startX, double startY);
 	virtual ~Oil();
 
-	// returns false to override Goodie
-	virtual bool sprayable() const;
+	// runs Goodie's common functionality
+	virtual void doSomething(StudentWorld& world);
 
-private:
 	// spins racer accordingly
-	virtual void doActivity();
-
-	// Oil Slick doesn't increase score, so this returns 0
-	virtual int getScoreIncrease() const;
-	virtual int getSound() const;
-
-	// returns false to override Goodie
-	virtual bool destructible() const;
+	void doActivity(StudentWorld& world);
 };
 
 // Healing Goodie, derived from Goodie
-class Heal : public Goodie {
+class Heal final : public Goodie {
 public:
-	Heal(double startX, double startY, StudentWorld* world);
+	Heal(double startX, double startY);
 	virtual ~Heal();
 
-private:
-	// heals racer by damaging it by -10 hp, equivalent to a heal of 10 hp
-	virtual void doActivity();
+	// runs Goodie's common functionality
+	virtual void doSomething(StudentWorld& world);
 
-	// returns 250
-	virtual int getScoreIncrease() const;
+	// heals racer by 10 hp, up to RACER_MAX_HP
+	void doActivity(StudentWorld& world);
 };
 
 // Holy Water Goodie, derived from Goodie
-class HolyWater : public Goodie {
+class HolyWater final : public Goodie {
 public:
-	HolyWater(double startX, double startY, StudentWorld* world);
+	HolyWater(double startX, double startY);
 	virtual ~HolyWater();
 
-private:
-	// increases racer's sprays by 10
-	virtual void doActivity();
+	// runs Goodie's common functionality
+	virtual void doSomething(StudentWorld& world);
 
-	// returns 50
-	virtual int getScoreIncrease() const;
+	// increases racer's sprays by 10
+	void doActivity(StudentWorld& world);
 };
 
 // Lost Soul Goodie, derived from Goodie
-class Soul : public Goodie {
+class Soul final : public Goodie {
 public:
-	Soul(double startX, double startY, StudentWorld* world);
+	Soul(double startX, double startY);
 	virtual ~Soul();
 
-	// calls Goodie's doSomething() for common functionality, and also rotates clockwise by 10 as specified
-	virtual void doSomething();
+	// runs Goodie's common functionality
+	virtual void doSomething(StudentWorld& world);
 
-	// returns false to override Goodie
-	virtual bool sprayable() const;
+	// rotates clockwise by 10 as specified, every tick, touching the racer or not
+	void spin();
 
-private:
 	// increases souls saved in StudentWorld
-	virtual void doActivity();
-	virtual int getSound() const;
-
-	// returns 100
-	virtual int getScoreIncrease() const;
+	void doActivity(StudentWorld& world);
 };
 
 // Holy Water Projectile, derived from Actor
-class Spray : public Actor {
+class Spray final : public Actor {
 public:
-	Spray(double startX, double startY, int dir, StudentWorld* world);
+	Spray(double startX, double startY, int dir);
 	virtual ~Spray();
 
 	// if activated, do nothing
 	// if not activated, move accordingly, check if in bounds, and dissipate if moved its full distance
-	virtual void doSomething();
+	virtual void doSomething(StudentWorld& world);
 
 private:
 	int m_travelDist;
 };
 
+// Traits
+// category: row of COLLISION_MATRIX
+// hurtSound/dieSound: played when damaged or killed via damage(), SOUND_NONE for none
+// goodieSound/scoreIncrease/destructible: what colliding with a Goodie plays, scores, and whether it's used up
+
+template <>
+struct ActorTraits<GhostRacer> {
+	static const CollisionCategory category = CAT_RACER;
+	static const int hurtSound = SOUND_NONE;
+	static const int dieSound = SOUND_PLAYER_DIE;
+};
+
+template <>
+struct ActorTraits<Human> {
+	static const CollisionCategory category = CAT_PED;
+	static const int hurtSound = SOUND_PED_HURT;
+	static const int dieSound = SOUND_PED_DIE;
+};
+
+template <>
+struct ActorTraits<Zombie> {
+	static const CollisionCategory category = CAT_PED;
+	static const int hurtSound = SOUND_PED_HURT;
+	static const int dieSound = SOUND_PED_DIE;
+};
+
+template <>
+struct ActorTraits<Cab> {
+	static const CollisionCategory category = CAT_CAB;
+	static const int hurtSound = SOUND_VEHICLE_HURT;
+	static const int dieSound = SOUND_VEHICLE_DIE;
+};
+
+template <>
+struct ActorTraits<Oil> {
+	static const CollisionCategory category = CAT_OIL;
+	static const int goodieSound = SOUND_OIL_SLICK;
+	static const int scoreIncrease = 0;
+	static const bool destructible = false;
+};
+
+template <>
+struct ActorTraits<Heal> {
+	static const CollisionCategory category = CAT_GOODIE;
+	static const int goodieSound = SOUND_GOT_GOODIE;
+	static const int scoreIncrease = 250;
+	static const bool destructible = true;
+};
+
+template <>
+struct ActorTraits<HolyWater> {
+	static const CollisionCategory category = CAT_GOODIE;
+	static const int goodieSound = SOUND_GOT_GOODIE;
+	static const int scoreIncrease = 50;
+	static const bool destructible = true;
+};
+
+template <>
+struct ActorTraits<Soul> {
+	static const CollisionCategory category = CAT_SOUL;
+	static const int goodieSound = SOUND_GOT_SOUL;
+	static const int scoreIncrease = 100;
+	static const bool destructible = true;
+};
+
+template <>
+struct ActorTraits<Spray> {
+	static const CollisionCategory category = CAT_SPRAY;
+};
+
 // Non-member functions
 bool overlap(const Actor* a, const Actor* b);
 
+// as above, with a at (ax, ay) with radius aRadius, for actors whose position the MotionKernel holds
+bool overlap(fixed ax, fixed ay, fixed aRadius, const Actor* b);
+
 #endif // ACTOR_H_
@@ -0,0 +1,79 @@
+#include "ActorPool.h"
+#include "AllocStats.h"
+#include <memory>
+#include <new>
+#include <vector>
+using namespace std;
+
+// constants
+const size_t POOL_GRANULE = 8;
+const size_t POOL_MAX_SIZE = 256;	// larger objects go to the general purpose allocator
+const size_t POOL_SLAB_BLOCKS = 256;
+const size_t POOL_NUM_CLASSES = POOL_MAX_SIZE / POOL_GRANULE + 1;
+
+struct FreeBlock {
+	FreeBlock* next;
+};
+
+static FreeBlock* s_free[POOL_NUM_CLASSES];
+static size_t s_numFree[POOL_NUM_CLASSES];
+
+static vector<unique_ptr<unsigned char[]>>& slabs() {
+	static vector<unique_ptr<unsigned char[]>> s;
+	return s;
+}
+
+static size_t sizeClass(size_t size) {
+	return (size + POOL_GRANULE - 1) / POOL_GRANULE;
+}
+
+// new slab, with its blocks on the free list lowest address first
+static void addSlab(size_t c) {
+	size_t blockSize = c * POOL_GRANULE;
+	AllocScope scope(ALLOC_ACTOR_POOL);
+	unsigned char* slab = new unsigned char[blockSize * POOL_SLAB_BLOCKS];
+	slabs().emplace_back(slab);
+	for (size_t k = POOL_SLAB_BLOCKS; k > 0; --k) {
+		FreeBlock* block = reinterpret_cast<FreeBlock*>(slab + (k - 1) * blockSize);
+		block->next = s_free[c];
+		s_free[c] = block;
+	}
+	s_numFree[c] += POOL_SLAB_BLOCKS;
+}
+
+void* ActorPool::allocate(size_t size) {
+	if (size > POOL_MAX_SIZE)
+		return ::operator new(size);
+
+	size_t c = sizeClass(size);
+	if (s_free[c] == nullptr)
+		addSlab(c);
+
+	FreeBlock* block = s_free[c];
+	s_free[c] = block->next;
+	--s_numFree[c];
+	return block;
+}
+
+void ActorPool::deallocate(void* p, size_t size) {
+	if (p == nullptr)
+		return;
+	if (size > POOL_MAX_SIZE) {
+		::operator delete(p);
+		return;
+	}
+
+	size_t c = sizeClass(size);
+	FreeBlock* block = static_cast<FreeBlock*>(p);
+	block->next = s_free[c];
+	s_free[c] = block;
+	++s_numFree[c];
+}
+
+void ActorPool::reserve(size_t size, size_t count) {
+	if (size > POOL_MAX_SIZE)
+		return;
+	size_t c = sizeClass(size);
+	while (s_numFree[c] < count)
+		addSlab(c);
+}
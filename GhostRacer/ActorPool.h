@@ -0,0 +1,21 @@
+#ifndef ACTORPOOL_H_
+#define ACTORPOOL_H_
+
+#include <cstddef>
+
+// Fixed size block allocator behind Actor's operator new and delete
+// each size class (sizes rounded up to 8 bytes) is carved from slabs of many blocks, and freed blocks are
+// reused most recent first, so actors of a type sit next to each other instead of scattered across the heap,
+// and a steady stream of spawns and deaths doesn't go to the general purpose allocator
+// slabs are kept until the program exits
+
+class ActorPool {
+public:
+	static void* allocate(std::size_t size);
+	static void deallocate(void* p, std::size_t size);
+
+	// makes sure count blocks of size are free, so the next count allocations of it take no new slab
+	static void reserve(std::size_t size, std::size_t count);
+};
+
+#endif // ACTORPOOL_H_
@@ -0,0 +1,29 @@
+#ifndef ACTORSTATE_H_
+#define ACTORSTATE_H_
+
+#include "Fixed.h"
+#include <cstdint>
+
+// The state the simulation reads or writes for every actor every tick, packed into one small record
+// it's the first thing in each GraphObject, right after the vtable pointer, so a tick's movement, bounds,
+// overlap and liveness checks touch one cache line per actor
+// render and behaviour data that's only used now and then comes after it
+
+// flags
+const uint8_t STATE_ALIVE = 1;
+const uint8_t STATE_VISIBLE = 2;
+
+struct ActorState {
+	fixed x;
+	fixed y;
+	fixed speedX;
+	fixed speedY;
+	fixed size;
+	int16_t hp;
+	uint8_t imageID;
+	uint8_t flags;
+};
+
+static_assert(sizeof(ActorState) == 24, "ActorState should stay 24 bytes");
+
+#endif // ACTORSTATE_H_
@@ -0,0 +1,252 @@
+#include "AllocStats.h"
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+using namespace std;
+
+static const char* const ALLOC_CATEGORY_NAMES[NUM_ALLOC_CATEGORIES] = {
+	"other", "actor pool", "status text"
+};
+
+static const char* const ACTOR_TYPE_NAMES[IID_ROAD] = {
+	"Ghost Racer", "Yellow Border Line", "White Border Line", "Oil Slick", "Human", "Zombie", "Zombie Cab",
+	"Spray", "Healing Goodie", "Lost Soul", "Holy Water Goodie"
+};
+
+// how many warm ticks that allocate are printed while reporting, before the rest are only counted
+static const long long ALLOC_WARNINGS_SHOWN = 10;
+
+// in front of every block; 16 bytes, so the block after it is as aligned as malloc's
+struct BlockHeader {
+	size_t size;
+	size_t category;
+};
+
+// this thread's current category and counts; constant initialised, so the allocator can use them at any time
+static thread_local AllocCategory t_category = ALLOC_OTHER;
+static thread_local AllocTickCounts t_counts;
+
+// Global allocator
+
+static void* allocate(size_t size) {
+	BlockHeader* h = static_cast<BlockHeader*>(malloc(sizeof(BlockHeader) + (size == 0 ? 1 : size)));
+	if (h == nullptr)
+		return nullptr;
+	h->size = size;
+	h->category = t_category;
+	allocStats().allocated(t_category, static_cast<long long>(size));
+	return h + 1;
+}
+
+static void deallocate(void* p) {
+	if (p == nullptr)
+		return;
+	BlockHeader* h = static_cast<BlockHeader*>(p) - 1;
+	allocStats().freed(static_cast<AllocCategory>(h->category), static_cast<long long>(h->size));
+	free(h);
+}
+
+void* operator new(size_t size) {
+	if (void* p = allocate(size))
+		return p;
+	throw bad_alloc();
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+	return allocate(size);
+}
+
+void operator delete(void* p) noexcept {
+	deallocate(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+	deallocate(p);
+}
+
+void operator delete(void* p, const nothrow_t&) noexcept {
+	deallocate(p);
+}
+
+// AllocStats
+
+AllocStats::AllocStats()
+	: m_tickDepth(0), m_ticks(0), m_levelTicks(0), m_warmTicks(0), m_warmTicksAllocating(0), m_maxTickAllocs(0), m_reporting(false) {
+	Counters* all[NUM_ALLOC_CATEGORIES + 1];
+	all[0] = &m_total;
+	for (int c = 0; c < NUM_ALLOC_CATEGORIES; ++c)
+		all[c + 1] = &m_categories[c];
+	for (Counters* c : all) {
+		c->liveBytes = 0;
+		c->liveBlocks = 0;
+		c->peakBytes = 0;
+		c->allocs = 0;
+		c->frees = 0;
+	}
+	for (int t = 0; t < IID_ROAD; ++t)
+		m_actors[t] = ActorCounts();
+	m_tickStart = AllocTickCounts();
+	m_lastTick = AllocTickCounts();
+}
+
+void AllocStats::add(Counters& c, long long bytes) {
+	const long long live = c.liveBytes.fetch_add(bytes, memory_order_relaxed) + bytes;
+	c.liveBlocks.fetch_add(1, memory_order_relaxed);
+	c.allocs.fetch_add(1, memory_order_relaxed);
+	long long peak = c.peakBytes.load(memory_order_relaxed);
+	while (live > peak && !c.peakBytes.compare_exchange_weak(peak, live, memory_order_relaxed))
+		;
+}
+
+void AllocStats::allocated(AllocCategory c, long long bytes) {
+	add(m_total, bytes);
+	add(m_categories[c], bytes);
+	++t_counts.allocs;
+	t_counts.bytes += bytes;
+	++t_counts.categoryAllocs[c];
+}
+
+void AllocStats::freed(AllocCategory c, long long bytes) {
+	Counters* counters[2] = { &m_total, &m_categories[c] };
+	for (Counters* k : counters) {
+		k->liveBytes.fetch_sub(bytes, memory_order_relaxed);
+		k->liveBlocks.fetch_sub(1, memory_order_relaxed);
+		k->frees.fetch_add(1, memory_order_relaxed);
+	}
+	++t_counts.frees;
+}
+
+AllocCounts AllocStats::read(const Counters& c) {
+	AllocCounts counts = { c.liveBytes.load(memory_order_relaxed), c.liveBlocks.load(memory_order_relaxed),
+		c.peakBytes.load(memory_order_relaxed), c.allocs.load(memory_order_relaxed), c.frees.load(memory_order_relaxed) };
+	return counts;
+}
+
+long long AllocStats::getTotalAllocs() const {
+	return m_total.allocs.load(memory_order_relaxed);
+}
+
+AllocCounts AllocStats::getTotal() const {
+	return read(m_total);
+}
+
+AllocCounts AllocStats::getCategory(AllocCategory c) const {
+	return read(m_categories[c]);
+}
+
+ActorCounts AllocStats::getActors(int imageID) const {
+	return m_actors[imageID];
+}
+
+void AllocStats::actorCreated(int imageID, int size) {
+	ActorCounts& a = m_actors[imageID];
+	a.size = size;
+	++a.created;
+	if (++a.live > a.peak)
+		a.peak = a.live;
+}
+
+void AllocStats::actorDestroyed(int imageID) {
+	--m_actors[imageID].live;
+}
+
+void AllocStats::levelStarted() {
+	m_levelTicks = 0;
+}
+
+void AllocStats::tickStarted() {
+	if (m_tickDepth++ == 0)
+		m_tickStart = t_counts;
+}
+
+void AllocStats::tickFinished() {
+	if (--m_tickDepth > 0)
+		return;
+	AllocTickCounts& t = m_lastTick;
+	t.allocs = t_counts.allocs - m_tickStart.allocs;
+	t.frees = t_counts.frees - m_tickStart.frees;
+	t.bytes = t_counts.bytes - m_tickStart.bytes;
+	for (int c = 0; c < NUM_ALLOC_CATEGORIES; ++c)
+		t.categoryAllocs[c] = t_counts.categoryAllocs[c] - m_tickStart.categoryAllocs[c];
+
+	++m_ticks;
+	if (t.allocs > m_maxTickAllocs)
+		m_maxTickAllocs = t.allocs;
+	if (++m_levelTicks <= ALLOC_WARM_TICKS)
+		return;
+	++m_warmTicks;
+	if (t.allocs == 0)
+		return;
+
+	++m_warmTicksAllocating;
+	if (m_reporting && m_warmTicksAllocating <= ALLOC_WARNINGS_SHOWN) {
+		printf("Tick %lld allocated %lld blocks (%lld bytes) once warm:", m_ticks, t.allocs, t.bytes);
+		for (int c = 0; c < NUM_ALLOC_CATEGORIES; ++c) {
+			if (t.categoryAllocs[c] > 0)
+				printf(" %s %lld", ALLOC_CATEGORY_NAMES[c], t.categoryAllocs[c]);
+		}
+		printf("%s\n", m_warmTicksAllocating == ALLOC_WARNINGS_SHOWN ? " (no more will be shown)" : "");
+	}
+}
+
+const AllocTickCounts& AllocStats::getLastTick() const {
+	return m_lastTick;
+}
+
+long long AllocStats::getTicks() const {
+	return m_ticks;
+}
+
+long long AllocStats::getWarmTicks() const {
+	return m_warmTicks;
+}
+
+long long AllocStats::getWarmTicksAllocating() const {
+	return m_warmTicksAllocating;
+}
+
+bool AllocStats::isReporting() const {
+	return m_reporting;
+}
+
+void AllocStats::setReporting(bool on) {
+	m_reporting = on;
+}
+
+void AllocStats::printReport() const {
+	printf("\n%-20s %12s %10s %12s %12s %12s\n", "Heap", "live bytes", "blocks", "peak bytes", "allocs", "frees");
+	for (int c = 0; c < NUM_ALLOC_CATEGORIES; ++c) {
+		AllocCounts k = getCategory(static_cast<AllocCategory>(c));
+		printf("%-20s %12lld %10lld %12lld %12lld %12lld\n", ALLOC_CATEGORY_NAMES[c], k.liveBytes, k.liveBlocks, k.peakBytes, k.allocs, k.frees);
+	}
+	AllocCounts total = getTotal();
+	printf("%-20s %12lld %10lld %12lld %12lld %12lld\n", "total", total.liveBytes, total.liveBlocks, total.peakBytes, total.allocs, total.frees);
+
+	printf("\n%-20s %12s %10s %12s %12s\n", "Actors", "live", "bytes", "peak", "created");
+	for (int t = 0; t < IID_ROAD; ++t) {
+		const ActorCounts& a = m_actors[t];
+		if (a.created > 0)
+			printf("%-20s %12lld %10lld %12lld %12lld\n", ACTOR_TYPE_NAMES[t], a.live, a.live * a.size, a.peak, a.created);
+	}
+
+	printf("\n%lld ticks, at most %lld allocations in one; %lld of %lld warm ticks allocated\n",
+		m_ticks, m_maxTickAllocs, m_warmTicksAllocating, m_warmTicks);
+}
+
+AllocStats& allocStats() {
+	// never destroyed, as blocks are freed during and after static destruction
+	alignas(AllocStats) static unsigned char storage[sizeof(AllocStats)];
+	static AllocStats* stats = new (storage) AllocStats;
+	return *stats;
+}
+
+// AllocScope
+
+AllocScope::AllocScope(AllocCategory category)
+	: m_previous(t_category) {
+	t_category = category;
+}
+
+AllocScope::~AllocScope() {
+	t_category = m_previous;
+}
@@ -0,0 +1,135 @@
+#ifndef ALLOCSTATS_H_
+#define ALLOCSTATS_H_
+
+#include "GameConstants.h"
+#include <atomic>
+
+// Heap accounting, by what the memory is for and by tick
+// the global operator new and delete are replaced (in AllocStats.cpp) so every allocation is counted; each block
+// carries a small header with its size and the category current on its thread when it was allocated (see AllocScope),
+// so a free is charged to the category that allocated it, wherever it happens
+// actors come from ActorPool's slabs, so the heap only sees the slabs; the actors themselves are counted per type
+// as they're constructed and destroyed
+// StudentWorld::move() is bracketed by an AllocTick, and once a level has run ALLOC_WARM_TICKS ticks, any tick in which
+// move() allocates on its thread is flagged: warm ticks should reuse what the first ones allocated
+// GameController brackets each tick again, around its own bookkeeping and sounds; only the outermost AllocTick counts
+
+enum AllocCategory {
+	ALLOC_OTHER,
+	ALLOC_ACTOR_POOL,         // ActorPool slabs
+	ALLOC_STATUS_TEXT,        // the status line, as its strings grow
+	NUM_ALLOC_CATEGORIES
+};
+
+const int ALLOC_WARM_TICKS = 100;
+
+// heap use of one category, or all of them
+struct AllocCounts {
+	long long liveBytes;
+	long long liveBlocks;
+	long long peakBytes;
+	long long allocs;
+	long long frees;
+};
+
+// actors of one type
+struct ActorCounts {
+	long long live;
+	long long peak;
+	long long created;
+	int size;                 // bytes each
+};
+
+// what one tick's move() did to the heap, on the thread that ran it
+struct AllocTickCounts {
+	long long allocs;
+	long long frees;
+	long long bytes;          // allocated
+	long long categoryAllocs[NUM_ALLOC_CATEGORIES];
+};
+
+class AllocStats {
+public:
+	AllocStats();
+
+	// every thread's allocations since the program started
+	long long getTotalAllocs() const;
+	AllocCounts getTotal() const;
+	AllocCounts getCategory(AllocCategory c) const;
+	ActorCounts getActors(int imageID) const;
+
+	// the tick before the current one, or the last one if none is running
+	const AllocTickCounts& getLastTick() const;
+	long long getTicks() const;
+	long long getWarmTicks() const;
+	long long getWarmTicksAllocating() const;
+
+	// with reporting on, warm ticks that allocate are printed as they happen (the first few, anyway)
+	bool isReporting() const;
+	void setReporting(bool on);
+
+	// prints the categories, actor types and ticks
+	void printReport() const;
+
+	// called by the allocator, Actor, StudentWorld and AllocTick
+	void allocated(AllocCategory c, long long bytes);
+	void freed(AllocCategory c, long long bytes);
+	void actorCreated(int imageID, int size);
+	void actorDestroyed(int imageID);
+	void levelStarted();
+	void tickStarted();
+	void tickFinished();
+
+private:
+	struct Counters {
+		std::atomic<long long> liveBytes;
+		std::atomic<long long> liveBlocks;
+		std::atomic<long long> peakBytes;
+		std::atomic<long long> allocs;
+		std::atomic<long long> frees;
+	};
+
+	static void add(Counters& c, long long bytes);
+	static AllocCounts read(const Counters& c);
+
+	Counters m_total;
+	Counters m_categories[NUM_ALLOC_CATEGORIES];
+	ActorCounts m_actors[IID_ROAD];     // only the game thread constructs and destroys actors
+
+	// ticks only run on the game thread
+	AllocTickCounts m_tickStart;        // this thread's counts as the tick started
+	AllocTickCounts m_lastTick;
+	int m_tickDepth;                    // AllocTicks open
+	long long m_ticks;
+	long long m_levelTicks;
+	long long m_warmTicks;
+	long long m_warmTicksAllocating;
+	long long m_maxTickAllocs;
+	bool m_reporting;
+};
+
+AllocStats& allocStats();
+
+// allocations on this thread are charged to category until the scope ends
+class AllocScope {
+public:
+	explicit AllocScope(AllocCategory category);
+	~AllocScope();
+
+private:
+	AllocCategory m_previous;
+};
+
+// brackets a tick, see AllocStats
+class AllocTick {
+public:
+	AllocTick() {
+		allocStats().tickStarted();
+	}
+
+	~AllocTick() {
+		allocStats().tickFinished();
+	}
+};
+
+#endif // ALLOCSTATS_H_
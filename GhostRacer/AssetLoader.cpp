@@ -0,0 +1,361 @@
+#include "AssetLoader.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <utility>
+using namespace std;
+
+// constants
+const size_t TGA_HEADER_SIZE = 18;
+const size_t TGA_CHUNK_SIZE = 64 * 1024;  // how much of a compressed TGA is read at once
+
+static double msSince(chrono::steady_clock::time_point start) {
+	return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// the power of two gluBuild2DMipmaps() picks for a side: value rounded down, or up when the bit below the top one is set
+static int nearestPower(int value) {
+	int power = 1;
+	while (value > 1) {
+		if (value == 3)
+			return power * 4;
+		value >>= 1;
+		power *= 2;
+	}
+	return power;
+}
+
+// one input pixel's share of an output pixel when resampling along one axis
+struct Tap {
+	int index;
+	float weight;
+};
+
+// the input pixels each of out output pixels covers when in pixels are stretched or squeezed to fit,
+// each weighted by how much of it is covered, as a fraction of the output pixel
+static void coverage(int in, int out, vector<vector<Tap> >& taps) {
+	taps.assign(out, vector<Tap>());
+	const double scale = static_cast<double>(in) / out;
+	for (int o = 0; o < out; ++o) {
+		const double start = o * scale, end = (o + 1) * scale;
+		for (int i = static_cast<int>(start); i < in && i < end; ++i) {
+			Tap tap = { i, static_cast<float>((min<double>(i + 1, end) - max<double>(i, start)) / scale) };
+			taps[o].push_back(tap);
+		}
+	}
+}
+
+// resamples in to outWidth x outHeight, each output pixel the average of the input area it covers,
+// across then down
+static void resample(const MipLevel& in, int components, int outWidth, int outHeight, MipLevel& out) {
+	vector<vector<Tap> > across, down;
+	coverage(in.width, outWidth, across);
+	coverage(in.height, outHeight, down);
+
+	vector<float> rows(static_cast<size_t>(outWidth) * in.height * components);
+	for (int y = 0; y < in.height; ++y) {
+		const unsigned char* p = in.pixels.data() + static_cast<size_t>(y) * in.width * components;
+		float* q = rows.data() + static_cast<size_t>(y) * outWidth * components;
+		for (int x = 0; x < outWidth; ++x, q += components) {
+			for (const Tap& tap : across[x])
+				for (int c = 0; c < components; ++c)
+					q[c] += tap.weight * p[tap.index * components + c];
+		}
+	}
+
+	out.width = outWidth;
+	out.height = outHeight;
+	out.pixels.resize(static_cast<size_t>(outWidth) * outHeight * components);
+	const size_t rowFloats = static_cast<size_t>(outWidth) * components;
+	vector<float> sum(rowFloats);
+	for (int y = 0; y < outHeight; ++y) {
+		fill(sum.begin(), sum.end(), 0.0f);
+		for (const Tap& tap : down[y]) {
+			const float* p = rows.data() + tap.index * rowFloats;
+			for (size_t k = 0; k < rowFloats; ++k)
+				sum[k] += tap.weight * p[k];
+		}
+		unsigned char* q = out.pixels.data() + y * rowFloats;
+		for (size_t k = 0; k < rowFloats; ++k)
+			q[k] = static_cast<unsigned char>(min(255.0f, sum[k] + 0.5f));
+	}
+}
+
+// the next mipmap down from in: half the size each way (but at least 1), each pixel the rounded average of the 2 x 2
+// (or 2 x 1) it replaces
+static void halve(const MipLevel& in, int components, MipLevel& out) {
+	out.width = max(in.width / 2, 1);
+	out.height = max(in.height / 2, 1);
+	out.pixels.resize(static_cast<size_t>(out.width) * out.height * components);
+	const int stepX = in.width > 1 ? 1 : 0;
+	const int stepY = in.height > 1 ? 1 : 0;
+
+	for (int y = 0; y < out.height; ++y) {
+		const unsigned char* row0 = in.pixels.data() + static_cast<size_t>(2 * y * stepY) * in.width * components;
+		const unsigned char* row1 = row0 + static_cast<size_t>(stepY) * in.width * components;
+		unsigned char* q = out.pixels.data() + static_cast<size_t>(y) * out.width * components;
+		for (int x = 0; x < out.width; ++x) {
+			const int left = 2 * x * stepX * components;
+			const int right = left + stepX * components;
+			for (int c = 0; c < components; ++c, ++q)
+				*q = static_cast<unsigned char>((row0[left + c] + row0[right + c] + row1[left + c] + row1[right + c] + 2) / 4);
+		}
+	}
+}
+
+// a stream read a chunk at a time, so compressed pixels decode straight into the image as they arrive,
+// timing the reads apart from the decoding
+class ChunkReader {
+public:
+	ChunkReader(istream& in, double& readMs)
+		: m_in(in), m_readMs(readMs), m_buffer(TGA_CHUNK_SIZE), m_pos(0), m_end(0) {
+	}
+
+	// copies the next n bytes to out, returns false if the stream ends first
+	bool read(unsigned char* out, size_t n) {
+		while (n > 0) {
+			if (m_pos == m_end) {
+				// big reads, like an uncompressed image's pixels, skip the buffer
+				if (n >= m_buffer.size())
+					return readDirect(out, n);
+				if (!refill())
+					return false;
+			}
+			size_t k = min(n, m_end - m_pos);
+			memcpy(out, m_buffer.data() + m_pos, k);
+			m_pos += k;
+			out += k;
+			n -= k;
+		}
+		return true;
+	}
+
+	bool readByte(unsigned char& b) {
+		if (m_pos == m_end && !refill())
+			return false;
+		b = m_buffer[m_pos++];
+		return true;
+	}
+
+private:
+	bool refill() {
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		m_in.read(reinterpret_cast<char*>(m_buffer.data()), m_buffer.size());
+		m_pos = 0;
+		m_end = static_cast<size_t>(m_in.gcount());
+		m_readMs += msSince(start);
+		return m_end > 0;
+	}
+
+	bool readDirect(unsigned char* out, size_t n) {
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		m_in.read(reinterpret_cast<char*>(out), n);
+		m_readMs += msSince(start);
+		return static_cast<size_t>(m_in.gcount()) == n;
+	}
+
+	istream& m_in;
+	double& m_readMs;
+	vector<unsigned char> m_buffer;
+	size_t m_pos;   // the next unread byte in m_buffer
+	size_t m_end;   // and how many it holds
+};
+
+// decodes TGA run length packets from reader until out is filled with count pixels of components bytes each
+// packets may run across rows, but not past the end of the image
+template <int components>
+static bool decodeRle(ChunkReader& reader, unsigned char* out, size_t count) {
+	unsigned char* const end = out + count * components;
+	while (out < end) {
+		unsigned char header;
+		if (!reader.readByte(header))
+			return false;
+		const size_t n = (header & 0x7F) + 1;
+		if (n * components > static_cast<size_t>(end - out))
+			return false;
+		if (header & 0x80) {
+			// one pixel, repeated n times
+			unsigned char pixel[components];
+			if (!reader.read(pixel, components))
+				return false;
+			for (size_t k = 0; k < n; ++k, out += components)
+				memcpy(out, pixel, components);
+		} else {
+			// n pixels as they are
+			if (!reader.read(out, n * components))
+				return false;
+			out += n * components;
+		}
+	}
+	return true;
+}
+
+bool decodeTga(istream& in, DecodedSprite& sprite) {
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	double readMs = 0;
+	ChunkReader reader(in, readMs);
+	sprite.components = 0;
+	sprite.levels.clear();
+
+	unsigned char header[TGA_HEADER_SIZE];
+	if (!reader.read(header, TGA_HEADER_SIZE))
+		return false;
+	// image type 2 (color) or 3 (greyscale), or 10 or 11 for the same run length encoded, with no color map
+	const int type = header[2];
+	if (header[1] != 0 || (type != 2 && type != 3 && type != 10 && type != 11))
+		return false;
+	const int width = header[12] + header[13] * 256;
+	const int height = header[14] + header[15] * 256;
+	const int components = header[16] / 8;
+	if (components != 3 && components != 4)
+		return false;
+	unsigned char imageID[255];
+	if (!reader.read(imageID, header[0]))
+		return false;
+
+	// rows stay in the file's order, bottom first, as OpenGL and the loader this replaced take them
+	sprite.levels.resize(1);
+	MipLevel& image = sprite.levels[0];
+	image.width = width;
+	image.height = height;
+	image.pixels.resize(static_cast<size_t>(width) * height * components);
+	const size_t count = static_cast<size_t>(width) * height;
+	bool ok;
+	if (type == 2 || type == 3)
+		ok = reader.read(image.pixels.data(), image.pixels.size());
+	else if (components == 3)
+		ok = decodeRle<3>(reader, image.pixels.data(), count);
+	else
+		ok = decodeRle<4>(reader, image.pixels.data(), count);
+	if (!ok) {
+		sprite.levels.clear();
+		return false;
+	}
+
+	sprite.components = components;
+	sprite.readMs += readMs;
+	sprite.decodeMs += msSince(start) - readMs;
+	return true;
+}
+
+bool decodeSprite(const string& file, int maxMipSize, DecodedSprite& sprite) {
+	sprite.components = 0;
+	sprite.levels.clear();
+	sprite.fileBytes = 0;
+	sprite.readMs = sprite.decodeMs = sprite.mipMs = 0;
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	ifstream in(file, ios::in | ios::binary);
+	if (!in)
+		return false;
+	sprite.readMs = msSince(start);
+	if (!decodeTga(in, sprite))
+		return false;
+	in.clear();
+	sprite.fileBytes = static_cast<size_t>(max<streamoff>(in.tellg(), 0));
+	const int width = sprite.levels[0].width;
+	const int height = sprite.levels[0].height;
+	const int components = sprite.components;
+
+	if (maxMipSize > 0) {
+		start = chrono::steady_clock::now();
+		const int baseWidth = min(nearestPower(width), maxMipSize);
+		const int baseHeight = min(nearestPower(height), maxMipSize);
+		if (baseWidth != width || baseHeight != height) {
+			MipLevel base;
+			resample(sprite.levels[0], components, baseWidth, baseHeight, base);
+			sprite.levels[0] = move(base);
+		}
+		while (sprite.levels.back().width > 1 || sprite.levels.back().height > 1) {
+			MipLevel next;
+			halve(sprite.levels.back(), components, next);
+			sprite.levels.push_back(move(next));
+		}
+		sprite.mipMs = msSince(start);
+	}
+	return true;
+}
+
+bool loadSprites(const SpriteInfo* assets, int count, const string& assetPath, int maxMipSize, int threads,
+	const function<bool(const DecodedSprite&)>& upload, LoadTimings& timings) {
+	timings = LoadTimings();
+	timings.sprites = count;
+	if (threads <= 0)
+		threads = max(static_cast<int>(thread::hardware_concurrency()), 1);
+	threads = max(min(threads, count), 1);
+	timings.threads = threads;
+
+	vector<DecodedSprite> sprites(count);
+	mutex m;
+	condition_variable finished;
+	deque<int> done;      // decoded sprites waiting for the GL thread, -1 for one that failed
+	int next = 0;         // the next sprite a worker should take
+	bool stopping = false;
+
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	vector<thread> workers;
+	for (int t = 0; t < threads; ++t) {
+		workers.push_back(thread([&] {
+			for (;;) {
+				int k;
+				{
+					lock_guard<mutex> lock(m);
+					if (stopping || next == count)
+						return;
+					k = next++;
+				}
+				DecodedSprite& sprite = sprites[k];
+				sprite.imageID = assets[k].imageID;
+				sprite.frameNum = assets[k].frameNum;
+				bool ok = decodeSprite(assetPath + assets[k].tgaFileName, maxMipSize, sprite);
+				{
+					lock_guard<mutex> lock(m);
+					done.push_back(ok ? k : -1);
+				}
+				finished.notify_one();
+			}
+		}));
+	}
+
+	bool ok = true;
+	for (int uploaded = 0; ok && uploaded < count; ++uploaded) {
+		chrono::steady_clock::time_point waitStart = chrono::steady_clock::now();
+		int k;
+		{
+			unique_lock<mutex> lock(m);
+			finished.wait(lock, [&] { return !done.empty(); });
+			k = done.front();
+			done.pop_front();
+		}
+		timings.waitMs += msSince(waitStart);
+		if (k < 0) {
+			ok = false;
+			break;
+		}
+
+		chrono::steady_clock::time_point uploadStart = chrono::steady_clock::now();
+		ok = upload(sprites[k]);
+		timings.uploadMs += msSince(uploadStart);
+
+		// the GL copy is made, so the pixels can go
+		timings.fileBytes += sprites[k].fileBytes;
+		timings.readMs += sprites[k].readMs;
+		timings.decodeMs += sprites[k].decodeMs;
+		timings.mipMs += sprites[k].mipMs;
+		vector<MipLevel>().swap(sprites[k].levels);
+	}
+
+	{
+		lock_guard<mutex> lock(m);
+		stopping = true;
+	}
+	for (thread& worker : workers)
+		worker.join();
+	timings.wallMs = msSince(start);
+	return ok;
+}
@@ -0,0 +1,64 @@
+#ifndef ASSETLOADER_H_
+#define ASSETLOADER_H_
+
+#include "SpriteAssets.h"
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+
+// Startup sprite loading, split into the part that needs the GL context and the part that doesn't
+// reading each TGA, decoding it and building its mipmaps is done on a pool of worker threads,
+// and only the texture uploads run on the thread that owns the context, each as soon as its sprite is ready
+
+// one mipmap level, with pixels in the TGA's byte order (BGR or BGRA) and its row order (bottom row first)
+struct MipLevel {
+	int width;
+	int height;
+	std::vector<unsigned char> pixels;
+};
+
+struct DecodedSprite {
+	unsigned int imageID;
+	unsigned int frameNum;
+	int components;                 // 3 for BGR, 4 for BGRA, 0 until decoded
+	std::vector<MipLevel> levels;   // the image as stored first, then its power of two mipmaps, if any
+	size_t fileBytes;               // how much of the file was read
+	double readMs;                  // how long each stage took for this sprite
+	double decodeMs;
+	double mipMs;
+};
+
+// where the time went while loading, with the per sprite stages summed over every worker
+struct LoadTimings {
+	int sprites;
+	int threads;
+	size_t fileBytes;
+	double wallMs;      // from the first read starting to the last upload finishing
+	double readMs;
+	double decodeMs;
+	double mipMs;
+	double uploadMs;    // on the GL thread
+	double waitMs;      // the GL thread waiting for the workers
+};
+
+// decodes a 24 or 32 bit TGA, uncompressed (types 2 and 3) or run length encoded (types 10 and 11), from in into
+// sprite.levels[0], adding the time spent reading and decoding to sprite's
+// compressed pixels are decoded as each chunk of the stream is read, straight into the image
+// returns false if in isn't a TGA we handle or ends early
+bool decodeTga(std::istream& in, DecodedSprite& sprite);
+
+// reads a TGA file with decodeTga(), then, if maxMipSize isn't 0, appends mipmaps
+// the way gluBuild2DMipmaps() makes them: the image resampled to the nearest power of two no bigger than maxMipSize
+// on a side, then halved down to 1 x 1
+// returns false if the file can't be read or isn't a TGA we handle
+bool decodeSprite(const std::string& file, int maxMipSize, DecodedSprite& sprite);
+
+// decodes the count sprites in assets, from assetPath (empty or ending in '/'), on up to threads workers (0 for one per
+// core), and calls upload on the calling thread for each in the order they finish
+// stops early and returns false if a sprite can't be decoded or upload returns false
+bool loadSprites(const SpriteInfo* assets, int count, const std::string& assetPath, int maxMipSize, int threads,
+	const std::function<bool(const DecodedSprite&)>& upload, LoadTimings& timings);
+
+#endif // ASSETLOADER_H_
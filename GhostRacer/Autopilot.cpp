@@ -0,0 +1,248 @@
+#include "Autopilot.h"
+#include "StudentWorld.h"
+#include "GameConstants.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <cstddef>
+using namespace std;
+
+static const int CHOICES[PLAN_NUM_CHOICES] = {
+	0, KEY_PRESS_LEFT, KEY_PRESS_RIGHT, KEY_PRESS_UP, KEY_PRESS_DOWN, KEY_PRESS_SPACE
+};
+
+static const float RACER_RADIUS = 32;	// GhostRacer has size 4.0
+static const float SPRAY_RANGE = 160;
+
+// cos and sin for each whole degree, since the racer's direction is always a whole number
+static const float* trigTable() {
+	static float table[2 * 360];
+	static bool built = false;
+	if (!built) {
+		for (int d = 0; d < 360; ++d) {
+			table[d] = static_cast<float>(cos(d * 4 * atan(1.0) / 180));
+			table[360 + d] = static_cast<float>(sin(d * 4 * atan(1.0) / 180));
+		}
+		built = true;
+	}
+	return table;
+}
+
+// same test as overlap() in Actor.cpp
+static bool planOverlap(float ax, float ay, float ar, float bx, float by, float br) {
+	return fabs(ax - bx) < (ar + br) * 0.25f && fabs(ay - by) < (ar + br) * 0.6f;
+}
+
+// copies only the live part of src, so forks of sparse worlds stay cheap
+static void fork(PlanState& dst, const PlanState& src) {
+	memcpy(&dst, &src, offsetof(PlanState, hazards) + src.numHazards * sizeof(PlanHazard));
+}
+
+static void removeHazard(PlanState& s, int k) {
+	s.hazards[k] = s.hazards[--s.numHazards];
+}
+
+// the spray hits the closest sprayable hazard along the racer's heading within range
+static void fireSpray(PlanState& s) {
+	const float* trig = trigTable();
+	float cosDir = trig[s.dir], sinDir = trig[360 + s.dir];
+	int hit = -1;
+	float hitDist = SPRAY_RANGE;
+	for (int k = 0; k < s.numHazards; ++k) {
+		const PlanHazard& h = s.hazards[k];
+		if (h.kind == PLAN_OIL || h.kind == PLAN_SOUL)
+			continue;
+		float dy = h.y - s.y;
+		if (dy <= 0 || dy >= hitDist)
+			continue;
+		float sprayX = s.x + cosDir / sinDir * dy;
+		if (fabs(h.x - sprayX) < (h.radius + 8) * 0.25f) {
+			hit = k;
+			hitDist = dy;
+		}
+	}
+	if (hit == -1)
+		return;
+
+	PlanHazard& h = s.hazards[hit];
+	switch (h.kind) {
+	case PLAN_ZOMBIE:
+		if (--h.hp <= 0) {
+			s.value += 150;
+			removeHazard(s, hit);
+		}
+		break;
+	case PLAN_CAB:
+		if (--h.hp <= 0) {
+			s.value += 200;
+			removeHazard(s, hit);
+		}
+		break;
+	case PLAN_HEAL:
+	case PLAN_HOLY_WATER:
+		removeHazard(s, hit);
+		break;
+	}
+}
+
+Autopilot::Autopilot()
+	: m_beam(PLAN_BEAM_WIDTH), m_next(PLAN_BEAM_WIDTH * PLAN_NUM_CHOICES),
+	m_order(PLAN_BEAM_WIDTH * PLAN_NUM_CHOICES), m_forks(0), m_nodes(0) {}
+
+void Autopilot::step(PlanState& s, int choice) {
+	if (s.dead)
+		return;
+
+	// racer, mirrors GhostRacer::doSomething
+	if (s.x <= LEFT_BOUND) {
+		if (s.dir > 90)
+			s.hp -= 10;
+		s.dir = 82;
+	}
+	else if (s.x >= RIGHT_BOUND) {
+		if (s.dir < 90)
+			s.hp -= 10;
+		s.dir = 98;
+	}
+	else {
+		switch (choice) {
+		case KEY_PRESS_LEFT:
+			if (s.dir < 114)
+				s.dir += 8;
+			break;
+		case KEY_PRESS_RIGHT:
+			if (s.dir > 66)
+				s.dir -= 8;
+			break;
+		case KEY_PRESS_UP:
+			if (s.speedY < 5)
+				s.speedY += 1;
+			break;
+		case KEY_PRESS_DOWN:
+			if (s.speedY > -1)
+				s.speedY -= 1;
+			break;
+		case KEY_PRESS_SPACE:
+			if (s.sprays > 0) {
+				--s.sprays;
+				fireSpray(s);
+			}
+			break;
+		}
+	}
+	s.x += trigTable()[s.dir] * 4;
+
+	// hazards, mirrors the contact half of each actor's doSomething
+	for (int k = 0; k < s.numHazards;) {
+		PlanHazard& h = s.hazards[k];
+		h.x += h.speedX;
+		h.y += h.speedY - s.speedY;
+		if (h.y < 0 || h.y > VIEW_HEIGHT) {
+			removeHazard(s, k);
+			continue;
+		}
+		if (!planOverlap(h.x, h.y, h.radius, s.x, s.y, RACER_RADIUS)) {
+			++k;
+			continue;
+		}
+
+		switch (h.kind) {
+		case PLAN_HUMAN:
+			s.dead = true;
+			break;
+		case PLAN_ZOMBIE:
+			s.hp -= 5;
+			break;
+		case PLAN_CAB:
+			s.hp -= 20;
+			break;
+		case PLAN_OIL:
+			// spin direction is random, so just count it against this fork
+			s.value -= 50;
+			break;
+		case PLAN_HEAL:
+			s.hp = min(s.hp + 10, 100);
+			s.value += 250;
+			break;
+		case PLAN_HOLY_WATER:
+			s.sprays += 10;
+			s.value += 50;
+			break;
+		case PLAN_SOUL:
+			++s.souls;
+			s.value += 100;
+			break;
+		}
+
+		// oil slicks stay put, everything else is used up or flies off
+		if (h.kind == PLAN_OIL)
+			++k;
+		else
+			removeHazard(s, k);
+	}
+
+	if (s.hp <= 0)
+		s.dead = true;
+
+	// small reward for making progress down the road
+	s.value += s.speedY;
+}
+
+float Autopilot::evaluate(const PlanState& s) {
+	if (s.dead)
+		return -1e9f;
+
+	// stay away from the yellow borders
+	float edge = fabs(s.x - ROAD_CENTER) - (ROAD_WIDTH / 2.0f - 16);
+	float edgePenalty = edge > 0 ? edge * 20 : 0;
+
+	return s.value + s.souls * 1000.0f + s.hp * 20.0f + s.sprays * 2.0f - edgePenalty;
+}
+
+int Autopilot::plan(const PlanState& root) {
+	int beamSize = 1;
+	fork(m_beam[0], root);
+	m_beam[0].firstChoice = 0;
+
+	// ranking scores, kept on the stack since the size is fixed
+	float scores[PLAN_BEAM_WIDTH * PLAN_NUM_CHOICES];
+
+	for (int depth = 0; depth < PLAN_DEPTH; ++depth) {
+		int n = 0;
+		for (int b = 0; b < beamSize; ++b) {
+			for (int c = 0; c < PLAN_NUM_CHOICES; ++c) {
+				PlanState& f = m_next[n];
+				fork(f, m_beam[b]);
+				++m_forks;
+				if (depth == 0)
+					f.firstChoice = CHOICES[c];
+
+				// steering and speed keys are held for the whole step, a spray is only fired once
+				for (int t = 0; t < PLAN_TICKS_PER_STEP; ++t) {
+					step(f, (t > 0 && CHOICES[c] == KEY_PRESS_SPACE) ? 0 : CHOICES[c]);
+					++m_nodes;
+				}
+
+				scores[n] = evaluate(f);
+				m_order[n] = n;
+				++n;
+			}
+		}
+
+		beamSize = min(n, PLAN_BEAM_WIDTH);
+		partial_sort(m_order.begin(), m_order.begin() + beamSize, m_order.begin() + n,
+			[&scores](int a, int b) { return scores[a] > scores[b]; });
+		for (int b = 0; b < beamSize; ++b)
+			fork(m_beam[b], m_next[m_order[b]]);
+	}
+
+	return m_beam[0].firstChoice;
+}
+
+long long Autopilot::getForks() const {
+	return m_forks;
+}
+
+long long Autopilot::getNodes() const {
+	return m_nodes;
+}
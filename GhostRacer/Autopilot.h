@@ -0,0 +1,72 @@
+#ifndef AUTOPILOT_H_
+#define AUTOPILOT_H_
+
+#include <vector>
+
+// Search-based autopilot for GhostRacer
+// plans ahead by forking a compact model of the world and trying every key choice,
+// keeping the best PLAN_BEAM_WIDTH forks at each step (beam search)
+
+const int PLAN_MAX_HAZARDS = 48;	// only the nearest this many actors to the racer are modelled, those ahead first
+const int PLAN_DEPTH = 12;			// number of planning steps
+const int PLAN_TICKS_PER_STEP = 3;	// ticks each key choice is held for, so PLAN_DEPTH * 3 ticks ahead
+const int PLAN_BEAM_WIDTH = 24;
+const int PLAN_NUM_CHOICES = 6;		// none, LEFT, RIGHT, UP, DOWN, SPACE
+
+// kinds of actors the planner models
+enum PlanKind { PLAN_HUMAN, PLAN_ZOMBIE, PLAN_CAB, PLAN_OIL, PLAN_HEAL, PLAN_HOLY_WATER, PLAN_SOUL };
+
+struct PlanHazard {
+	float x;
+	float y;
+	float speedX;
+	float speedY;
+	float radius;
+	signed char kind;
+	signed char hp;
+};
+
+// everything a fork needs, in fixed size storage so forking is a flat copy
+struct PlanState {
+	float x;
+	float y;
+	float speedY;
+	int dir;
+	int hp;
+	int sprays;
+	int souls;
+	bool dead;
+	float value;		// accumulated reward along this fork
+	int firstChoice;	// key choice this fork started with
+	int numHazards;
+	PlanHazard hazards[PLAN_MAX_HAZARDS];
+};
+
+class Autopilot {
+public:
+	Autopilot();
+
+	// searches from root and returns the key to press this tick, or 0 if none
+	int plan(const PlanState& root);
+
+	// running totals, for measuring forks/sec and nodes/sec
+	long long getForks() const;
+	long long getNodes() const;
+
+	// advances s by one tick with the given key choice, exposed for benchmarking
+	static void step(PlanState& s, int choice);
+
+private:
+	// scores a fork for ranking within the beam
+	static float evaluate(const PlanState& s);
+
+	// preallocated beams, swapped each step so planning never allocates
+	std::vector<PlanState> m_beam;
+	std::vector<PlanState> m_next;
+	std::vector<int> m_order;
+
+	long long m_forks;
+	long long m_nodes;
+};
+
+#endif // AUTOPILOT_H_
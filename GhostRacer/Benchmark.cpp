@@ -0,0 +1,749 @@
+#include "Benchmark.h"
+#include "AllocStats.h"
+#include "StudentWorld.h"
+#include "Actor.h"
+#include "Autopilot.h"
+#include "MotionKernel.h"
+#include "SoftwareRenderer.h"
+#include "FrameCapture.h"
+#include "Metrics.h"
+#include "AssetLoader.h"
+#include "GameConstants.h"
+#include "GameController.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+// constants
+const double MIN_BENCH_NS = 2e8;		// grow the iteration count until a case runs for at least 0.2 s
+const int MOVE_TICKS_PER_BATCH = 10;	// ticks per freshly populated world, so densities stay close to the target
+const int POPULATE_MIN_Y = 100;			// keep populated actors clear of the racer for a batch
+const double REGRESSION_THRESHOLD = 0.10;
+const size_t CACHE_EVICT_BYTES = 64 << 20;	// larger than any last level cache we run on
+const int RECORD_MS_PER_TICK = 15;			// recordings play back at the game's default speed
+const int LOAD_BENCH_MIP_SIZE = 2048;		// at least what any GL the game runs on allows
+const int OBS_CHECK_POSITIONS = 1 << 20;	// binned both ways before the cases run
+const char* const DECODE_BENCH_TGA = "oil.tga";	// the biggest sprite, mostly transparent like the rest
+
+struct BenchResult {
+	string name;
+	int param;
+	double nsPerOp;
+	double allocsPerOp;
+	double actors;
+	double forksPerSec;		// world clones and ticks simulated by the autopilot's search, 0 for other cases
+	double nodesPerSec;
+};
+
+// times and counts allocations only between start() and stop(), so cases can exclude their setup
+class BenchTimer {
+public:
+	BenchTimer() : m_ns(0), m_allocs(0), m_startAllocs(0), m_forks(0), m_nodes(0) {}
+
+	void start() {
+		m_startAllocs = allocStats().getTotalAllocs();
+		m_start = chrono::steady_clock::now();
+	}
+
+	void stop() {
+		m_ns += chrono::duration<double, nano>(chrono::steady_clock::now() - m_start).count();
+		m_allocs += allocStats().getTotalAllocs() - m_startAllocs;
+	}
+
+	// for cases that search, the forks and nodes their timed ops searched
+	void searched(long long forks, long long nodes) {
+		m_forks += forks;
+		m_nodes += nodes;
+	}
+
+	double ns() const { return m_ns; }
+	long long allocs() const { return m_allocs; }
+	long long forks() const { return m_forks; }
+	long long nodes() const { return m_nodes; }
+
+private:
+	chrono::steady_clock::time_point m_start;
+	double m_ns;
+	long long m_allocs;
+	long long m_startAllocs;
+	long long m_forks;
+	long long m_nodes;
+};
+
+// a case runs iters ops, timing them with the timer, and returns the average actor count it ran with
+using BenchBody = function<double(long long iters, BenchTimer& timer)>;
+
+static BenchResult measure(string name, int param, BenchBody body) {
+	long long iters = 1;
+	for (;;) {
+		BenchTimer timer;
+		double actors = body(iters, timer);
+		if (timer.ns() >= MIN_BENCH_NS || iters >= (1LL << 40)) {
+			const double seconds = max(timer.ns(), 1.0) / 1e9;
+			BenchResult r = { name, param, timer.ns() / iters, static_cast<double>(timer.allocs()) / iters, actors,
+				timer.forks() / seconds, timer.nodes() / seconds };
+			return r;
+		}
+		iters *= 4;
+	}
+}
+
+static int laneOf(double x) {
+	if (x < LEFT_MID_BOUND)
+		return LEFT_LANE;
+	if (x < RIGHT_MID_BOUND)
+		return MIDDLE_LANE;
+	return RIGHT_LANE;
+}
+
+// adds n actors of mixed types spread over the road above the racer
+static void populate(StudentWorld& w, int n) {
+	for (int k = 0; k < n; ++k) {
+		double x = randInt(LEFT_BOUND + 1, RIGHT_BOUND - 1);
+		double y = randInt(POPULATE_MIN_Y, VIEW_HEIGHT);
+		switch (k % 6) {
+		case 0: w.addActor(new Human(x, y));						break;
+		case 1: w.addActor(new Zombie(x, y));						break;
+		case 2: w.addActor(new Cab(x, y, 2, laneOf(x)));			break;
+		case 3: w.addActor(new Oil(x, y));							break;
+		case 4: w.addActor(new HolyWater(x, y));					break;
+		case 5: w.addActor(new Heal(x, y));							break;
+		}
+	}
+}
+
+// writes over a buffer bigger than the caches, so the next op starts with none of the world cached
+static void evictCaches() {
+	static vector<unsigned char> buffer(CACHE_EVICT_BYTES);
+	for (size_t k = 0; k < buffer.size(); k += 64)
+		++buffer[k];
+}
+
+// fresh world with n actors
+static void resetWorld(StudentWorld& w, int n) {
+	w.cleanUp();
+	w.init();
+	populate(w, n);
+}
+
+// stores sprite's pixels as a TGA in out, run length encoded (type 10) or not (type 2)
+// runs of two or more equal pixels are packed as repeats and everything else as literals
+static void writeTga(const DecodedSprite& sprite, bool rle, string& out) {
+	const MipLevel& image = sprite.levels[0];
+	const int c = sprite.components;
+	unsigned char header[18] = {};
+	header[2] = rle ? 10 : 2;
+	header[12] = image.width & 0xFF;
+	header[13] = image.width >> 8;
+	header[14] = image.height & 0xFF;
+	header[15] = image.height >> 8;
+	header[16] = static_cast<unsigned char>(c * 8);
+	header[17] = c == 4 ? 8 : 0;  // alpha bits
+	out.assign(reinterpret_cast<const char*>(header), sizeof(header));
+
+	const char* p = reinterpret_cast<const char*>(image.pixels.data());
+	const size_t count = static_cast<size_t>(image.width) * image.height;
+	if (!rle) {
+		out.append(p, count * c);
+		return;
+	}
+	auto same = [p, c](size_t a, size_t b) { return memcmp(p + a * c, p + b * c, c) == 0; };
+	for (size_t k = 0; k < count; ) {
+		size_t n = 1;
+		while (k + n < count && n < 128 && same(k, k + n))
+			++n;
+		if (n >= 2) {
+			out += static_cast<char>(0x80 | (n - 1));
+			out.append(p + k * c, c);
+		} else {
+			// a literal run, up to where the next repeat starts
+			while (k + n < count && n < 128 && !(k + n + 1 < count && same(k + n, k + n + 1)))
+				++n;
+			out += static_cast<char>(n - 1);
+			out.append(p + k * c, n * c);
+		}
+		k += n;
+	}
+}
+
+static vector<BenchResult> runCases() {
+	vector<BenchResult> results;
+	const int densities[] = { 100, 1000, 10000 };
+
+	results.push_back(measure("overlap", 0, [](long long iters, BenchTimer& timer) {
+		StudentWorld w("");
+		w.init();
+		Zombie a(ROAD_CENTER, 100);
+		Zombie b(ROAD_CENTER + 4, 120);
+		volatile int hits = 0;
+		timer.start();
+		for (long long i = 0; i < iters; ++i)
+			hits += overlap(&a, &b);
+		timer.stop();
+		return 2.0;
+	}));
+
+	for (int n : densities) {
+		results.push_back(measure("checkCabFrontOrBack", n, [n](long long iters, BenchTimer& timer) {
+			StudentWorld w("");
+			resetWorld(w, n);
+			Cab* cab = new Cab(ROAD_CENTER, POPULATE_MIN_Y / 2, 2, MIDDLE_LANE);
+			w.addActor(cab);
+			volatile int result = 0;
+			timer.start();
+			for (long long i = 0; i < iters; ++i)
+				result += w.checkCabFrontOrBack(MIDDLE_LANE, cab);
+			timer.stop();
+			return static_cast<double>(w.getNumActors());
+		}));
+	}
+
+	for (int n : densities) {
+		results.push_back(measure("activatedSpray", n, [n](long long iters, BenchTimer& timer) {
+			// spray off the road, so it never hits anything and every call scans all actors
+			StudentWorld w("");
+			resetWorld(w, n);
+			Spray* spray = new Spray(4, VIEW_HEIGHT / 2, 90);
+			w.addActor(spray);
+			volatile int hits = 0;
+			timer.start();
+			for (long long i = 0; i < iters; ++i)
+				hits += w.activatedSpray(spray);
+			timer.stop();
+			return static_cast<double>(w.getNumActors());
+		}));
+	}
+
+	for (int n : densities) {
+		results.push_back(measure("Actor::doSomething", n, [n](long long iters, BenchTimer& timer) {
+			// Goodies moving themselves, as they did before the MotionKernel, kept out of the world so it doesn't move them too
+			StudentWorld w("");
+			w.init();
+			vector<Heal*> goodies;
+			for (int k = 0; k < n; ++k)
+				goodies.push_back(new Heal(LEFT_MID_BOUND, VIEW_HEIGHT));
+			timer.start();
+			for (long long i = 0; i < iters;) {
+				for (int k = 0; k < n && i < iters; ++k, ++i)
+					goodies[k]->Actor::doSomething(w);
+			}
+			timer.stop();
+			for (int k = 0; k < n; ++k)
+				delete goodies[k];
+			return static_cast<double>(n);
+		}));
+	}
+
+	for (int n : densities) {
+		results.push_back(measure("MotionKernel::update", n, [n](long long iters, BenchTimer& timer) {
+			StudentWorld w("");
+			w.init();
+			MotionKernel kernel;
+			vector<Heal*> goodies;
+			for (int k = 0; k < n; ++k) {
+				goodies.push_back(new Heal(LEFT_MID_BOUND, VIEW_HEIGHT));
+				kernel.add(goodies.back());
+			}
+			// scrolled by the Goodies' own speed, so they hold still on screen however many ticks run
+			const ::fixed scroll = n > 0 ? goodies[0]->getFixedSpeedY() : 0;
+			timer.start();
+			for (long long i = 0; i < iters; i += n)
+				kernel.update(scroll, w.getRacer());
+			timer.stop();
+			for (int k = 0; k < n; ++k)
+				delete goodies[k];
+			return static_cast<double>(n);
+		}));
+	}
+
+	for (int n : densities) {
+		results.push_back(measure("StudentWorld::move", n, [n](long long iters, BenchTimer& timer) {
+			StudentWorld w("");
+			double actorTicks = 0;
+			for (long long i = 0; i < iters;) {
+				resetWorld(w, n);
+				for (int t = 0; t < MOVE_TICKS_PER_BATCH && i < iters; ++t, ++i) {
+					actorTicks += w.getNumActors();
+					timer.start();
+					w.move();
+					timer.stop();
+				}
+			}
+			return actorTicks / iters;
+		}));
+	}
+
+	// as above, but each tick starts with cold caches, so it's dominated by the misses touching every actor
+	for (int n : densities) {
+		results.push_back(measure("StudentWorld::move/cold", n, [n](long long iters, BenchTimer& timer) {
+			StudentWorld w("");
+			double actorTicks = 0;
+			for (long long i = 0; i < iters;) {
+				resetWorld(w, n);
+				for (int t = 0; t < MOVE_TICKS_PER_BATCH && i < iters; ++t, ++i) {
+					actorTicks += w.getNumActors();
+					evictCaches();
+					timer.start();
+					w.move();
+					timer.stop();
+				}
+			}
+			return actorTicks / iters;
+		}));
+	}
+
+	results.push_back(measure("init/cleanUp", 0, [](long long iters, BenchTimer& timer) {
+		StudentWorld w("");
+		w.init();
+		int actors = w.getNumActors();
+		timer.start();
+		for (long long i = 0; i < iters; ++i) {
+			w.cleanUp();
+			w.init();
+		}
+		timer.stop();
+		return static_cast<double>(actors);
+	}));
+
+	results.push_back(measure("randInt", 0, [](long long iters, BenchTimer& timer) {
+		volatile int sum = 0;
+		timer.start();
+		for (long long i = 0; i < iters; ++i)
+			sum += randInt(0, 99);
+		timer.stop();
+		return 0.0;
+	}));
+
+	for (int n : densities) {
+		results.push_back(measure("getObservation", n, [n](long long iters, BenchTimer& timer) {
+			StudentWorld w("");
+			resetWorld(w, n);
+			vector<float> obs(OBS_SIZE);
+			timer.start();
+			for (long long i = 0; i < iters; ++i)
+				w.getObservation(obs.data());
+			timer.stop();
+			return static_cast<double>(w.getNumActors());
+		}));
+	}
+
+	for (int n : densities) {
+		results.push_back(measure("Autopilot::plan", n, [n](long long iters, BenchTimer& timer) {
+			StudentWorld w("");
+			resetWorld(w, n);
+			Autopilot pilot;
+			PlanState root;
+			w.getPlanState(root);
+			timer.start();
+			for (long long i = 0; i < iters; ++i)
+				pilot.plan(root);
+			timer.stop();
+			timer.searched(pilot.getForks(), pilot.getNodes());
+			return static_cast<double>(root.numHazards);
+		}));
+	}
+
+	// only when the sprites can be found, since the other cases don't need the assets
+	SoftwareRenderer renderer;
+	if (renderer.loadSprites("Assets/")) {
+		for (int n : densities) {
+			results.push_back(measure("SoftwareRenderer::render", n, [n, &renderer](long long iters, BenchTimer& timer) {
+				StudentWorld w("");
+				resetWorld(w, n);
+				vector<SpriteDraw> draws;
+				timer.start();
+				for (long long i = 0; i < iters; ++i) {
+					draws.clear();
+					w.syncDrawnPositions();
+					SoftwareRenderer::collectDraws(draws);
+					renderer.render(draws, toFixed(w.getRoadScroll()));
+				}
+				timer.stop();
+				return static_cast<double>(w.getNumActors());
+			}));
+		}
+
+		// startup's read, decode and mipmap work without the uploads, on one thread and on every core
+		const int cores = max(static_cast<int>(thread::hardware_concurrency()), 1);
+		vector<int> threadCounts = { 1 };
+		if (cores > 1)
+			threadCounts.push_back(cores);
+		for (int threads : threadCounts) {
+			results.push_back(measure("loadSprites", threads, [threads](long long iters, BenchTimer& timer) {
+				LoadTimings timings;
+				timer.start();
+				for (long long i = 0; i < iters; ++i)
+					loadSprites(SPRITE_ASSETS, NUM_SPRITE_ASSETS, "Assets/", LOAD_BENCH_MIP_SIZE, threads,
+						[](const DecodedSprite&) { return true; }, timings);
+				timer.stop();
+				return 0.0;
+			}));
+		}
+
+		// TGA decoding alone, from memory, of the same pixels stored uncompressed and run length encoded
+		// the param is the decoded size in KB, so ns/op over it is the decoder's throughput
+		DecodedSprite sprite;
+		if (decodeSprite("Assets/" + string(DECODE_BENCH_TGA), 0, sprite)) {
+			const MipLevel& image = sprite.levels[0];
+			const int kb = static_cast<int>(image.pixels.size() / 1024);
+			string files[2];
+			writeTga(sprite, false, files[0]);
+			writeTga(sprite, true, files[1]);
+			const char* names[2] = { "decodeTga::raw", "decodeTga::rle" };
+			for (int k = 0; k < 2; ++k) {
+				const string& file = files[k];
+				results.push_back(measure(names[k], kb, [&file](long long iters, BenchTimer& timer) {
+					istringstream in(file);
+					DecodedSprite decoded = DecodedSprite();	// decodeTga() adds its timings to these
+					timer.start();
+					for (long long i = 0; i < iters; ++i) {
+						in.clear();
+						in.seekg(0);
+						decodeTga(in, decoded);
+					}
+					timer.stop();
+					return 0.0;
+				}));
+			}
+		}
+	}
+
+	return results;
+}
+
+static void writeJson(const vector<BenchResult>& results, ostream& out) {
+	out << "{\n  \"benchmarks\": [\n";
+	for (size_t k = 0; k < results.size(); ++k) {
+		const BenchResult& r = results[k];
+		out << "    {\"name\": \"" << r.name << "\", \"param\": " << r.param
+			<< ", \"ns_per_op\": " << r.nsPerOp << ", \"allocs_per_op\": " << r.allocsPerOp
+			<< ", \"actors\": " << r.actors;
+		if (r.forksPerSec > 0)
+			out << ", \"forks_per_sec\": " << r.forksPerSec << ", \"nodes_per_sec\": " << r.nodesPerSec;
+		out << "}" << (k + 1 < results.size() ? "," : "") << "\n";
+	}
+	out << "  ]\n}\n";
+}
+
+// reads back a file written by writeJson, one case per line
+static bool readJson(string file, vector<BenchResult>& results) {
+	ifstream in(file);
+	if (!in)
+		return false;
+
+	string line;
+	while (getline(in, line)) {
+		size_t name = line.find("\"name\": \"");
+		if (name == string::npos)
+			continue;
+
+		BenchResult r;
+		name += 9;
+		r.name = line.substr(name, line.find('"', name) - name);
+		auto field = [&line](string key) {
+			size_t pos = line.find("\"" + key + "\": ");
+			return pos == string::npos ? 0.0 : atof(line.c_str() + pos + key.size() + 4);
+		};
+		r.param = static_cast<int>(field("param"));
+		r.nsPerOp = field("ns_per_op");
+		r.allocsPerOp = field("allocs_per_op");
+		r.actors = field("actors");
+		r.forksPerSec = field("forks_per_sec");
+		r.nodesPerSec = field("nodes_per_sec");
+		results.push_back(r);
+	}
+	return true;
+}
+
+static string caseName(const BenchResult& r) {
+	ostringstream oss;
+	oss << r.name;
+	if (r.param != 0)
+		oss << "/" << r.param;
+	return oss.str();
+}
+
+int runBenchmarks(string jsonFile) {
+	if (!checkObservationBinning(OBS_CHECK_POSITIONS)) {
+		cout << "The SSE2 and scalar observation binning disagree" << endl;
+		return 1;
+	}
+	vector<BenchResult> results = runCases();
+
+	for (const BenchResult& r : results) {
+		printf("%-28s %14.1f ns/op %10.2f allocs/op %10.0f actors",
+			caseName(r).c_str(), r.nsPerOp, r.allocsPerOp, r.actors);
+		if (r.forksPerSec > 0)
+			printf(" %12.0f forks/s %12.0f nodes/s", r.forksPerSec, r.nodesPerSec);
+		printf("\n");
+	}
+
+	ofstream out(jsonFile);
+	if (!out) {
+		cout << "Cannot write " << jsonFile << endl;
+		return 1;
+	}
+	writeJson(results, out);
+	cout << "Wrote " << jsonFile << endl;
+	return 0;
+}
+
+// number of GraphObjects across every depth's list
+static size_t countGraphObjects() {
+	size_t n = 0;
+	for (unsigned int depth = 0; depth < 4 /* NUM_DEPTHS */; ++depth)
+		n += GraphObject::getGraphObjects(depth).size();
+	return n;
+}
+
+static void printStressTicks(const char* label, const StressStats& stats, double totalNs, int ticks, double actors) {
+	double other = totalNs - stats.cabCheckNs - stats.sprayCheckNs - stats.spawnNs - stats.destroyNs;
+	printf("%-8s %8.0f actors %9.3f ms/tick | cab checks %9.3f ms (%lld) | spray checks %9.3f ms (%lld)"
+		" | spawn %7.3f ms (%lld) | destroy %7.3f ms (%lld) | other %8.3f ms | racer revived %lld\n",
+		label, actors, totalNs / ticks / 1e6,
+		stats.cabCheckNs / ticks / 1e6, stats.cabChecks / ticks,
+		stats.sprayCheckNs / ticks / 1e6, stats.sprayChecks / ticks,
+		stats.spawnNs / ticks / 1e6, stats.spawns / ticks,
+		stats.destroyNs / ticks / 1e6, stats.destroys / ticks,
+		other / ticks / 1e6, stats.racerDeaths);
+}
+
+int renderFrame(string assetPath, string tgaFile, int ticks) {
+	SoftwareRenderer renderer;
+	if (!renderer.loadSprites(assetPath)) {
+		cout << "Cannot load the sprites from " << (assetPath.empty() ? "the current directory" : assetPath) << endl;
+		return 1;
+	}
+
+	StudentWorld w(assetPath);
+	w.init();
+	for (int t = 0; t < ticks; ++t) {
+		if (w.move() != GWSTATUS_CONTINUE_GAME)
+			break;
+	}
+
+	vector<SpriteDraw> draws;
+	w.syncDrawnPositions();
+	SoftwareRenderer::collectDraws(draws);
+	renderer.render(draws, toFixed(w.getRoadScroll()));
+	w.cleanUp();
+	if (!renderer.writeTga(tgaFile)) {
+		cout << "Cannot write " << tgaFile << endl;
+		return 1;
+	}
+	cout << "Wrote " << tgaFile << " (" << draws.size() << " sprites)" << endl;
+	return 0;
+}
+
+int recordRun(string assetPath, string path, int ticks) {
+	SoftwareRenderer renderer;
+	if (!renderer.loadSprites(assetPath)) {
+		cout << "Cannot load the sprites from " << (assetPath.empty() ? "the current directory" : assetPath) << endl;
+		return 1;
+	}
+	const RgbaImage& frame = renderer.getFramebuffer();
+	FrameCapture capture;
+	if (!capture.start(path, frame.width, frame.height, RECORD_MS_PER_TICK)) {
+		cout << "Cannot capture to " << path << endl;
+		return 1;
+	}
+
+	StudentWorld w(assetPath);
+	w.setAutopilot(true);
+	w.init();
+	vector<SpriteDraw> draws;
+	double renderNs = 0;
+	int t = 0;
+	auto nextTick = chrono::steady_clock::now();
+	while (t < ticks) {
+		// tick at the game's own pace, so the drop count says whether the encoder keeps up with a real game
+		this_thread::sleep_until(nextTick);
+		nextTick += chrono::milliseconds(RECORD_MS_PER_TICK);
+
+		int status = w.move();
+		++t;
+
+		auto start = chrono::steady_clock::now();
+		draws.clear();
+		w.syncDrawnPositions();
+		SoftwareRenderer::collectDraws(draws);
+		renderer.render(draws, toFixed(w.getRoadScroll()));
+		capture.submit(reinterpret_cast<const unsigned char*>(frame.pixels.data()), false);
+		metrics().frameDrawn();
+		renderNs += chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+
+		if (status == GWSTATUS_FINISHED_LEVEL) {
+			w.advanceToNextLevel();
+			w.cleanUp();
+			w.init();
+		}
+		else if (status != GWSTATUS_CONTINUE_GAME)
+			break;  // the autopilot crashed
+	}
+	w.cleanUp();
+	capture.stop();
+
+	CaptureStats stats = capture.getStats();
+	printf("%d ticks, %.3f ms/tick rendering and queueing | captured %lld of %lld frames (%lld dropped, %lld failed)\n",
+		t, renderNs / max(t, 1) / 1e6, stats.written, stats.submitted, stats.dropped, stats.failed);
+	return stats.failed == 0 ? 0 : 1;
+}
+
+int runStress(const StressScenario& scenario, int ticks) {
+	const int reportEvery = max(ticks / 10, 1);
+
+	StudentWorld w("");
+	w.setScenario(scenario);
+	w.init();
+	printf("pre-populated %d actors, %u GraphObjects\n", w.getNumActors(), static_cast<unsigned>(countGraphObjects()));
+	w.resetStressStats();
+
+	StressStats total = StressStats();
+	double totalNs = 0, intervalNs = 0, actorTicks = 0;
+	int intervalTicks = 0;
+	for (int t = 1; t <= ticks; ++t) {
+		actorTicks += w.getNumActors();
+
+		auto start = chrono::steady_clock::now();
+		int status = w.move();
+		double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+		totalNs += ns;
+		intervalNs += ns;
+		++intervalTicks;
+
+		if (status == GWSTATUS_FINISHED_LEVEL) {
+			w.advanceToNextLevel();
+			w.cleanUp();
+			w.init();
+		}
+
+		if (t % reportEvery == 0 || t == ticks) {
+			const StressStats& stats = w.getStressStats();
+			char label[32];
+			snprintf(label, sizeof(label), "%d", t);
+			printStressTicks(label, stats, intervalNs, intervalTicks, w.getNumActors());
+
+			total.cabCheckNs += stats.cabCheckNs;
+			total.sprayCheckNs += stats.sprayCheckNs;
+			total.spawnNs += stats.spawnNs;
+			total.destroyNs += stats.destroyNs;
+			total.cabChecks += stats.cabChecks;
+			total.sprayChecks += stats.sprayChecks;
+			total.spawns += stats.spawns;
+			total.destroys += stats.destroys;
+			total.racerDeaths += stats.racerDeaths;
+			w.resetStressStats();
+			intervalNs = 0;
+			intervalTicks = 0;
+		}
+	}
+
+	printStressTicks("total", total, totalNs, ticks, actorTicks / ticks);
+	return 0;
+}
+
+// runs ticks ticks of w, starting the level again whenever it ends, and prints how many warm ticks allocated
+// returns whether none did
+static bool checkWarmTicks(const char* label, StudentWorld& w, int ticks) {
+	AllocStats& stats = allocStats();
+	const long long warm = stats.getWarmTicks(), allocating = stats.getWarmTicksAllocating();
+	w.init();
+	for (int t = 0; t < ticks; ++t) {
+		int status = w.move();
+		if (status == GWSTATUS_FINISHED_LEVEL)
+			w.advanceToNextLevel();
+		if (status != GWSTATUS_CONTINUE_GAME) {
+			w.cleanUp();
+			w.init();
+		}
+	}
+	w.cleanUp();
+
+	const long long flagged = stats.getWarmTicksAllocating() - allocating;
+	printf("%-24s %lld of %lld warm ticks allocated\n", label, flagged, stats.getWarmTicks() - warm);
+	return flagged == 0;
+}
+
+// as checkWarmTicks(), with the game controller's per-frame work around the ticks; each frame is one warm tick
+static bool checkWarmFrames(const char* label, StudentWorld& w, int frames, int turboTicks) {
+	AllocStats& stats = allocStats();
+	const long long warm = stats.getWarmTicks(), allocating = stats.getWarmTicksAllocating();
+	Game().runHeadless(&w, frames, turboTicks);
+
+	const long long flagged = stats.getWarmTicksAllocating() - allocating;
+	printf("%-24s %lld of %lld warm frames allocated\n", label, flagged, stats.getWarmTicks() - warm);
+	return flagged == 0;
+}
+
+int checkSteadyAllocs(int ticks) {
+	allocStats().setReporting(true);
+	bool steady = true;
+	{
+		StudentWorld w("");
+		w.setAutopilot(true);
+		steady = checkWarmTicks("autopilot", w, ticks) && steady;
+	}
+	const StressScenario scenarios[] = { { 10, 10, 3, 5, 2 }, { 40, 40, 10, 30, 10 } };
+	for (const StressScenario& scenario : scenarios) {
+		char label[64];
+		snprintf(label, sizeof(label), "stress %d %d %d %d %d", scenario.humans, scenario.zombies, scenario.cabs,
+			scenario.goodies, scenario.sprays);
+		StudentWorld w("");
+		w.setScenario(scenario);
+		steady = checkWarmTicks(label, w, ticks) && steady;
+	}
+	// the controller's share (keys, latency, sounds, status and overlay text), at normal speed and in turbo
+	const int turbos[] = { 1, 8 };
+	for (int turbo : turbos) {
+		char label[64];
+		snprintf(label, sizeof(label), "controller turbo x%d", turbo);
+		StudentWorld w("");
+		w.setAutopilot(true);
+		steady = checkWarmFrames(label, w, ticks, turbo) && steady;
+	}
+	return steady ? 0 : 1;
+}
+
+int compareBenchmarks(string baselineFile, string resultsFile) {
+	vector<BenchResult> baseline, results;
+	if (!readJson(baselineFile, baseline) || !readJson(resultsFile, results)) {
+		cout << "Cannot read " << baselineFile << " or " << resultsFile << endl;
+		return 1;
+	}
+
+	int regressions = 0;
+	for (const BenchResult& r : results) {
+		const BenchResult* base = nullptr;
+		for (const BenchResult& b : baseline) {
+			if (b.name == r.name && b.param == r.param)
+				base = &b;
+		}
+		if (base == nullptr) {
+			printf("%-28s %14.1f ns/op  (new)\n", caseName(r).c_str(), r.nsPerOp);
+			continue;
+		}
+
+		double change = base->nsPerOp > 0 ? r.nsPerOp / base->nsPerOp - 1 : 0;
+		bool regressed = change > REGRESSION_THRESHOLD || r.allocsPerOp > base->allocsPerOp + 0.01;
+		if (regressed)
+			++regressions;
+		printf("%-28s %14.1f -> %14.1f ns/op %+7.1f%% %8.2f -> %8.2f allocs/op%s\n",
+			caseName(r).c_str(), base->nsPerOp, r.nsPerOp, change * 100,
+			base->allocsPerOp, r.allocsPerOp, regressed ? "  REGRESSION" : "");
+	}
+
+	cout << regressions << " regression(s)" << endl;
+	return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,40 @@
+#ifndef BENCHMARK_H_
+#define BENCHMARK_H_
+
+#include <string>
+
+// Headless microbenchmarks and stress scenarios for the simulation hot paths
+// run with "GhostRacer -bench [results.json]", "GhostRacer -compare baseline.json results.json"
+// "GhostRacer -stress humans zombies cabs goodies sprays [ticks]", "GhostRacer -render frame.tga [ticks]"
+// "GhostRacer -record run.y4m|frames/shot ticks" and "GhostRacer -alloccheck [ticks]"
+
+struct StressScenario;
+
+// runs every benchmark case, prints a table and writes the results to jsonFile
+// returns the process exit status
+int runBenchmarks(std::string jsonFile);
+
+// compares two result files, printing each case and flagging regressions against the baseline
+// returns 1 if anything regressed, 0 otherwise
+int compareBenchmarks(std::string baselineFile, std::string resultsFile);
+
+// runs ticks ticks of a world with no input and draws the last one with the software renderer into tgaFile
+// returns the process exit status
+int renderFrame(std::string assetPath, std::string tgaFile, int ticks);
+
+// lets the autopilot play up to ticks ticks, capturing every one with the software renderer to a Y4M video or PNG sequence
+// (see FrameCapture::start()), and prints how many frames were written and dropped
+// returns the process exit status
+int recordRun(std::string assetPath, std::string path, int ticks);
+
+// runs ticks ticks of a world held at the scenario's actor counts, printing where each tick's time goes
+// returns the process exit status
+int runStress(const StressScenario& scenario, int ticks);
+
+// runs the autopilot and a couple of stress scenarios for ticks ticks each, flagging every tick that allocates once
+// its level is warm (see AllocStats), then the autopilot again under the game controller with no window, flagging
+// every frame that does
+// returns 1 if any did, 0 otherwise
+int checkSteadyAllocs(int ticks);
+
+#endif // BENCHMARK_H_
@@ -0,0 +1,30 @@
+#ifndef COLLISION_H_
+#define COLLISION_H_
+
+// Collision categories, and which pairs of them can ever interact
+// COLLISION_MATRIX[a][b] is true if actors of category a look for actors of category b:
+// contact with the racer, spray hits, and Zombie Cab lane avoidance only test the pairs marked here,
+// so e.g. a spray is never overlap-tested against an Oil Slick
+// the racer hits the road's edges by position, as the road's lines are drawn with the road rather than being actors
+enum CollisionCategory { CAT_RACER, CAT_PED, CAT_CAB, CAT_GOODIE, CAT_OIL, CAT_SOUL, CAT_SPRAY, NUM_CATEGORIES };
+
+constexpr bool COLLISION_MATRIX[NUM_CATEGORIES][NUM_CATEGORIES] = {
+	//	racer	ped		cab		goodie	oil		soul	spray
+	{	false,	false,	false,	false,	false,	false,	false	},	// racer
+	{	true,	false,	false,	false,	false,	false,	false	},	// ped
+	{	true,	true,	true,	false,	false,	false,	false	},	// cab
+	{	true,	false,	false,	false,	false,	false,	false	},	// goodie (Healing and Holy Water)
+	{	true,	false,	false,	false,	false,	false,	false	},	// oil
+	{	true,	false,	false,	false,	false,	false,	false	},	// soul
+	{	false,	true,	true,	true,	false,	false,	false	}	// spray
+};
+
+// whether actors of category a ever test actors of category b
+constexpr bool collides(CollisionCategory a, CollisionCategory b) {
+	return COLLISION_MATRIX[a][b];
+}
+
+static_assert(!collides(CAT_SPRAY, CAT_SOUL) && !collides(CAT_SPRAY, CAT_OIL),
+	"sprays only hit Pedestrians, Zombie Cabs, and Healing and Holy Water Goodies");
+
+#endif // COLLISION_H_
@@ -0,0 +1,62 @@
+#include "EventBuffer.h"
+
+// constants
+const int INITIAL_CAPACITY = 256;	// more than a busy tick posts, so the buffer rarely grows
+
+EventBuffer::EventBuffer() {
+	m_events.reserve(INITIAL_CAPACITY);
+}
+
+void EventBuffer::damage(Actor* target, int dmg) {
+	post(EVENT_DAMAGE, target, dmg);
+}
+
+void EventBuffer::heal(int hp) {
+	post(EVENT_HEAL, nullptr, hp);
+}
+
+void EventBuffer::kill(Actor* target) {
+	post(EVENT_KILL, target, 0);
+}
+
+void EventBuffer::score(int points) {
+	post(EVENT_SCORE, nullptr, points);
+}
+
+void EventBuffer::sound(int soundID) {
+	post(EVENT_SOUND, nullptr, soundID);
+}
+
+void EventBuffer::spawn(Actor* a) {
+	post(EVENT_SPAWN, a, 0);
+}
+
+void EventBuffer::soulSaved() {
+	post(EVENT_SOUL_SAVED, nullptr, 1);
+}
+
+void EventBuffer::spin(int degrees) {
+	post(EVENT_SPIN, nullptr, degrees);
+}
+
+void EventBuffer::sprays(int count) {
+	post(EVENT_SPRAYS, nullptr, count);
+}
+
+int EventBuffer::size() const {
+	return static_cast<int>(m_events.size());
+}
+
+const Event& EventBuffer::operator[](int k) const {
+	return m_events[k];
+}
+
+void EventBuffer::clear() {
+	m_events.clear();
+}
+
+// private
+void EventBuffer::post(EventType type, Actor* actor, int value) {
+	Event e = { type, actor, value };
+	m_events.push_back(e);
+}
@@ -0,0 +1,58 @@
+#ifndef EVENTBUFFER_H_
+#define EVENTBUFFER_H_
+
+#include <vector>
+
+class Actor;
+
+// Interactions between actors, recorded while actors update and applied by StudentWorld at the end of the tick
+// during the update, an actor only changes itself; anything it does to another actor, the score, the sound
+// or the actor collections is posted here instead, so no update sees another's effects in the same tick
+// events posted while applying (e.g. a Zombie killed by a spray dropping a Healing Goodie) are applied in the same batch
+
+enum EventType {
+	EVENT_DAMAGE,		// actor->damage(value), skipped if actor died earlier in the batch
+	EVENT_HEAL,			// heal the racer by value, up to RACER_MAX_HP as it is when applied, skipped if it died
+	EVENT_KILL,			// actor->kill(DEATH_HIT)
+	EVENT_SCORE,		// increase score by value
+	EVENT_SOUND,		// play sound value
+	EVENT_SPAWN,		// add actor to the world
+	EVENT_SOUL_SAVED,	// one more Lost Soul saved
+	EVENT_SPIN,			// turn the racer by value degrees
+	EVENT_SPRAYS		// give the racer value more sprays
+};
+
+struct Event {
+	EventType type;
+	Actor* actor;
+	int value;
+};
+
+class EventBuffer {
+public:
+	EventBuffer();
+
+	void damage(Actor* target, int dmg);
+	void heal(int hp);
+	void kill(Actor* target);
+	void score(int points);
+	void sound(int soundID);
+	void spawn(Actor* a);
+	void soulSaved();
+	void spin(int degrees);
+	void sprays(int count);
+
+	// events in the order they were posted
+	int size() const;
+	const Event& operator[](int k) const;
+
+	// forgets every event, keeping the storage for the next tick
+	void clear();
+
+private:
+	void post(EventType type, Actor* actor, int value);
+
+	std::vector<Event> m_events;
+};
+
+#endif // EVENTBUFFER_H_
@@ -0,0 +1,31 @@
+#ifndef FIXED_H_
+#define FIXED_H_
+
+#include <cstdint>
+#include <cmath>
+
+// Fixed point numbers for the simulation state
+// positions, sizes and speeds are Q16.16 (16 integer bits, 16 fraction bits) in 32 bits, and trig comes from a table,
+// so the same inputs give bit-identical results on every build, whatever the compiler does with floating point
+// the double getters and setters around them convert exactly one way, and round to the nearest 1/65536 the other
+
+typedef int32_t fixed;
+
+const int FIXED_SHIFT = 16;
+const fixed FIXED_ONE = 1 << FIXED_SHIFT;
+
+// nearest fixed to d
+inline fixed toFixed(double d) {
+	return static_cast<fixed>(std::floor(d * FIXED_ONE + 0.5));
+}
+
+// exact
+inline double fromFixed(fixed f) {
+	return static_cast<double>(f) / FIXED_ONE;
+}
+
+// sine and cosine of an angle in whole degrees, any sign or size
+fixed fixedSin(int degrees);
+fixed fixedCos(int degrees);
+
+#endif // FIXED_H_
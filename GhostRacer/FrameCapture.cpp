@@ -0,0 +1,357 @@
+#include "FrameCapture.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+using namespace std;
+
+// constants
+const size_t DEFLATE_MAX_STORED = 65535;  // most bytes one uncompressed deflate block holds
+const int PNG_DIGITS = 6;                 // frame000000.png
+const uint32_t ADLER_MOD = 65521;
+const size_t ADLER_RUN = 5552;            // most bytes the Adler-32 sums take before they must be reduced
+const int Y4M_RATE_DIGITS = 10;           // a measured rate's numerator, zero padded so it can be filled in later
+const long long Y4M_RATE_SCALE = 1000;    // a measured rate is written in thousandths of a frame per second
+const long long Y4M_DEFAULT_RATE = 60;    // what a measured rate says until there are two frames to measure
+
+FrameCapture::FrameCapture()
+	: m_y4m(false), m_width(0), m_height(0), m_rateAt(-1), m_queueHead(0), m_queueSize(0), m_acquired(-1),
+	  m_committed(0), m_running(false), m_stopping(false), m_stats() {
+}
+
+FrameCapture::~FrameCapture() {
+	stop();
+}
+
+static bool endsWith(const string& s, const string& suffix) {
+	return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+bool FrameCapture::start(string path, int width, int height, int msPerFrame, int poolSize) {
+	if (m_running || width <= 0 || height <= 0 || poolSize < 1 || msPerFrame < 0)
+		return false;
+
+	m_path = path;
+	m_y4m = endsWith(path, ".y4m");
+	m_width = width;
+	m_height = height;
+	if (m_y4m) {
+		m_video.open(path, ios::out | ios::binary);
+		if (!m_video)
+			return false;
+		// full range BT.601 with 4:2:0 chroma, as writeY4m() converts to
+		m_video << "YUV4MPEG2 W" << width << " H" << height << " F";
+		if (msPerFrame > 0) {
+			m_rateAt = -1;
+			m_video << 1000 << ":" << msPerFrame;
+		}
+		else {
+			m_rateAt = m_video.tellp();
+			char rate[32];
+			snprintf(rate, sizeof(rate), "%0*lld:%lld", Y4M_RATE_DIGITS, Y4M_DEFAULT_RATE * Y4M_RATE_SCALE, Y4M_RATE_SCALE);
+			m_video << rate;
+		}
+		m_video << " Ip A1:1 C420jpeg XCOLORRANGE=FULL\n";
+	}
+
+	// every buffer is allocated now, so capturing a frame never allocates
+	m_frames.resize(poolSize);
+	m_free.clear();
+	for (int k = poolSize - 1; k >= 0; --k) {
+		m_frames[k].pixels.resize(static_cast<size_t>(width) * height * 4);
+		m_free.push_back(k);
+	}
+	m_queue.assign(poolSize, -1);
+	m_queueHead = 0;
+	m_queueSize = 0;
+	m_acquired = -1;
+	m_committed = 0;
+	m_stats = CaptureStats();
+
+	m_stopping = false;
+	m_running = true;
+	m_encoder = thread(&FrameCapture::encodeLoop, this);
+	return true;
+}
+
+void FrameCapture::stop() {
+	{
+		lock_guard<mutex> lock(m_mutex);
+		if (!m_running)
+			return;
+		m_stopping = true;
+	}
+	m_ready.notify_one();
+	m_encoder.join();
+
+	if (m_video.is_open()) {
+		writeMeasuredRate();
+		m_video.close();
+	}
+	m_running = false;
+}
+
+// fills in the header's frame rate as the frames written over the time they were committed in, so the video lasts
+// as long as the capture did, whatever rate the frames were really displayed at and however many were dropped
+void FrameCapture::writeMeasuredRate() {
+	if (m_rateAt < 0 || m_committed < 2)
+		return;
+	long long us = chrono::duration_cast<chrono::microseconds>(m_lastCommit - m_firstCommit).count();
+	if (us <= 0)
+		return;
+	// the span between the first and last frames, plus the one frame the last is shown for
+	double seconds = us * 1e-6 * m_committed / (m_committed - 1);
+	long long rate = static_cast<long long>(m_stats.written * Y4M_RATE_SCALE / seconds + 0.5);
+	char text[32];
+	int length = snprintf(text, sizeof(text), "%0*lld", Y4M_RATE_DIGITS, max(rate, 1LL));
+	if (length != Y4M_RATE_DIGITS)
+		return;  // too fast to fit, so the default stays
+	m_video.seekp(m_rateAt);
+	m_video.write(text, length);
+}
+
+bool FrameCapture::isRunning() const {
+	return m_running;
+}
+
+int FrameCapture::getWidth() const {
+	return m_width;
+}
+
+int FrameCapture::getHeight() const {
+	return m_height;
+}
+
+unsigned char* FrameCapture::acquire() {
+	lock_guard<mutex> lock(m_mutex);
+	if (!m_running)
+		return nullptr;
+	++m_stats.submitted;
+	if (m_acquired >= 0 || m_free.empty()) {
+		++m_stats.dropped;
+		return nullptr;
+	}
+	m_acquired = m_free.back();
+	m_free.pop_back();
+	return m_frames[m_acquired].pixels.data();
+}
+
+void FrameCapture::commit(bool bottomUp) {
+	{
+		lock_guard<mutex> lock(m_mutex);
+		if (m_acquired < 0)
+			return;
+		Frame& frame = m_frames[m_acquired];
+		frame.bottomUp = bottomUp;
+		frame.number = m_committed++;
+		m_lastCommit = chrono::steady_clock::now();
+		if (frame.number == 0)
+			m_firstCommit = m_lastCommit;
+
+		// the ring holds as many entries as there are buffers, so it can't be full here
+		m_queue[(m_queueHead + m_queueSize) % m_queue.size()] = m_acquired;
+		++m_queueSize;
+		m_acquired = -1;
+	}
+	m_ready.notify_one();
+}
+
+bool FrameCapture::submit(const unsigned char* rgba, bool bottomUp) {
+	unsigned char* buffer = acquire();
+	if (buffer == nullptr)
+		return false;
+	memcpy(buffer, rgba, static_cast<size_t>(m_width) * m_height * 4);
+	commit(bottomUp);
+	return true;
+}
+
+CaptureStats FrameCapture::getStats() const {
+	lock_guard<mutex> lock(m_mutex);
+	return m_stats;
+}
+
+void FrameCapture::encodeLoop() {
+	for (;;) {
+		int index;
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_ready.wait(lock, [this] { return m_queueSize > 0 || m_stopping; });
+			if (m_queueSize == 0)
+				return;  // stopping, and everything queued is written
+			index = m_queue[m_queueHead];
+			m_queueHead = (m_queueHead + 1) % m_queue.size();
+			--m_queueSize;
+		}
+
+		bool ok = writeFrame(m_frames[index]);
+
+		lock_guard<mutex> lock(m_mutex);
+		m_free.push_back(index);
+		if (ok)
+			++m_stats.written;
+		else
+			++m_stats.failed;
+	}
+}
+
+bool FrameCapture::writeFrame(const Frame& frame) {
+	return m_y4m ? writeY4m(frame) : writePng(frame);
+}
+
+// PNG
+
+static uint32_t crc32(const unsigned char* data, size_t n, uint32_t crc = 0) {
+	static uint32_t table[256];
+	static bool tableMade = false;
+	if (!tableMade) {
+		for (uint32_t k = 0; k < 256; ++k) {
+			uint32_t c = k;
+			for (int bit = 0; bit < 8; ++bit)
+				c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+			table[k] = c;
+		}
+		tableMade = true;  // only the encoder thread gets here
+	}
+	crc = ~crc;
+	for (size_t k = 0; k < n; ++k)
+		crc = table[(crc ^ data[k]) & 0xFF] ^ (crc >> 8);
+	return ~crc;
+}
+
+static void putBigEndian(vector<unsigned char>& out, uint32_t v) {
+	out.push_back(v >> 24);
+	out.push_back((v >> 16) & 0xFF);
+	out.push_back((v >> 8) & 0xFF);
+	out.push_back(v & 0xFF);
+}
+
+// starts a chunk of type, leaving room for its length, and returns where it starts
+static size_t beginChunk(vector<unsigned char>& out, const char* type) {
+	size_t start = out.size();
+	putBigEndian(out, 0);
+	out.insert(out.end(), type, type + 4);
+	return start;
+}
+
+// fills in the length of the chunk at start, which runs to the end of out, and appends its CRC
+static void finishChunk(vector<unsigned char>& out, size_t start) {
+	uint32_t length = static_cast<uint32_t>(out.size() - start - 8);
+	out[start] = length >> 24;
+	out[start + 1] = (length >> 16) & 0xFF;
+	out[start + 2] = (length >> 8) & 0xFF;
+	out[start + 3] = length & 0xFF;
+	putBigEndian(out, crc32(out.data() + start + 4, length + 4));
+}
+
+// 8 bit RGB, stored without compression, which keeps the encoder fast enough to keep up with the game
+bool FrameCapture::writePng(const Frame& frame) {
+	// scanlines, each a filter type of 0 (none) then the row's RGB bytes, top row first
+	const size_t rowBytes = static_cast<size_t>(m_width) * 3 + 1;
+	m_raw.resize(rowBytes * m_height);
+	for (int row = 0; row < m_height; ++row) {
+		int source = frame.bottomUp ? m_height - 1 - row : row;
+		const unsigned char* in = frame.pixels.data() + static_cast<size_t>(source) * m_width * 4;
+		unsigned char* out = m_raw.data() + row * rowBytes;
+		*out++ = 0;
+		for (int col = 0; col < m_width; ++col, in += 4) {
+			*out++ = in[0];
+			*out++ = in[1];
+			*out++ = in[2];
+		}
+	}
+
+	static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	m_encoded.assign(signature, signature + 8);
+
+	size_t start = beginChunk(m_encoded, "IHDR");
+	putBigEndian(m_encoded, m_width);
+	putBigEndian(m_encoded, m_height);
+	const unsigned char format[5] = { 8, 2, 0, 0, 0 };  // 8 bits, RGB, deflate, adaptive filtering, not interlaced
+	m_encoded.insert(m_encoded.end(), format, format + 5);
+	finishChunk(m_encoded, start);
+
+	// zlib stream of stored deflate blocks
+	start = beginChunk(m_encoded, "IDAT");
+	m_encoded.push_back(0x78);
+	m_encoded.push_back(0x01);
+	uint32_t adlerA = 1, adlerB = 0;
+	for (size_t offset = 0; offset < m_raw.size(); offset += DEFLATE_MAX_STORED) {
+		size_t n = min(DEFLATE_MAX_STORED, m_raw.size() - offset);
+		m_encoded.push_back(offset + n == m_raw.size() ? 1 : 0);  // final block?
+		m_encoded.push_back(n & 0xFF);
+		m_encoded.push_back(n >> 8);
+		m_encoded.push_back(~n & 0xFF);
+		m_encoded.push_back((~n >> 8) & 0xFF);
+		const unsigned char* p = m_raw.data() + offset;
+		m_encoded.insert(m_encoded.end(), p, p + n);
+		for (size_t k = 0; k < n; ) {
+			// the sums can't overflow 32 bits within ADLER_RUN bytes, so only reduce them once per run
+			size_t end = min(n, k + ADLER_RUN);
+			for (; k < end; ++k) {
+				adlerA += p[k];
+				adlerB += adlerA;
+			}
+			adlerA %= ADLER_MOD;
+			adlerB %= ADLER_MOD;
+		}
+	}
+	putBigEndian(m_encoded, (adlerB << 16) | adlerA);
+	finishChunk(m_encoded, start);
+
+	start = beginChunk(m_encoded, "IEND");
+	finishChunk(m_encoded, start);
+
+	char number[16];
+	snprintf(number, sizeof(number), "%0*lld", PNG_DIGITS, frame.number);
+	ofstream out(m_path + number + ".png", ios::out | ios::binary);
+	out.write(reinterpret_cast<const char*>(m_encoded.data()), m_encoded.size());
+	return static_cast<bool>(out);
+}
+
+// Y4M
+
+static inline unsigned char clampByte(int v) {
+	return static_cast<unsigned char>(v < 0 ? 0 : (v > 255 ? 255 : v));
+}
+
+// one frame of full range BT.601 4:2:0, with each chroma sample taken from the average of its 2 x 2 pixels
+bool FrameCapture::writeY4m(const Frame& frame) {
+	const int chromaWidth = (m_width + 1) / 2;
+	const int chromaHeight = (m_height + 1) / 2;
+	const size_t lumaSize = static_cast<size_t>(m_width) * m_height;
+	const size_t chromaSize = static_cast<size_t>(chromaWidth) * chromaHeight;
+	m_encoded.resize(lumaSize + 2 * chromaSize);
+	unsigned char* luma = m_encoded.data();
+	unsigned char* cb = luma + lumaSize;
+	unsigned char* cr = cb + chromaSize;
+
+	auto rowPixels = [&](int row) {
+		int source = frame.bottomUp ? m_height - 1 - row : row;
+		return frame.pixels.data() + static_cast<size_t>(source) * m_width * 4;
+	};
+
+	for (int row = 0; row < m_height; ++row) {
+		const unsigned char* p = rowPixels(row);
+		unsigned char* out = luma + static_cast<size_t>(row) * m_width;
+		for (int col = 0; col < m_width; ++col, p += 4)
+			out[col] = static_cast<unsigned char>((77 * p[0] + 150 * p[1] + 29 * p[2] + 128) >> 8);
+	}
+	for (int row = 0; row < chromaHeight; ++row) {
+		const unsigned char* top = rowPixels(2 * row);
+		const unsigned char* bottom = rowPixels(min(2 * row + 1, m_height - 1));
+		for (int col = 0; col < chromaWidth; ++col) {
+			int left = 8 * col;
+			int right = 4 * min(2 * col + 1, m_width - 1);
+			int r = top[left] + top[right] + bottom[left] + bottom[right];
+			int g = top[left + 1] + top[right + 1] + bottom[left + 1] + bottom[right + 1];
+			int b = top[left + 2] + top[right + 2] + bottom[left + 2] + bottom[right + 2];
+			// the sums are 4 times the average, so shift by two more
+			cb[row * chromaWidth + col] = clampByte(((-43 * r - 85 * g + 128 * b + 512) >> 10) + 128);
+			cr[row * chromaWidth + col] = clampByte(((128 * r - 107 * g - 21 * b + 512) >> 10) + 128);
+		}
+	}
+
+	m_video << "FRAME\n";
+	m_video.write(reinterpret_cast<const char*>(m_encoded.data()), m_encoded.size());
+	return static_cast<bool>(m_video);
+}
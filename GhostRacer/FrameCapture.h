@@ -0,0 +1,99 @@
+#ifndef FRAMECAPTURE_H_
+#define FRAMECAPTURE_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Records rendered frames without stalling the game loop
+// frames are copied into a fixed pool of reusable buffers and handed to a background encoder thread,
+// which writes them as a PNG sequence or a raw Y4M video stream
+// if the encoder falls behind and every buffer is in use, the new frame is dropped and counted rather than waited for
+
+struct CaptureStats {
+	long long submitted;    // frames offered to the capture
+	long long written;      // frames the encoder has finished writing
+	long long dropped;      // frames skipped because no buffer was free
+	long long failed;       // frames the encoder couldn't write
+};
+
+class FrameCapture {
+public:
+	FrameCapture();
+	~FrameCapture();
+
+	// starts capturing width x height frames, one every msPerFrame ms, into path
+	// msPerFrame 0 means frames come as fast as they are displayed, and a video's rate is measured from when they
+	// were committed, and written into its header by stop()
+	// a path ending in ".y4m" is one video stream, anything else is the prefix of a numbered PNG sequence
+	// (path + "000000.png", path + "000001.png", ...)
+	// returns false if already capturing or the output can't be opened
+	bool start(std::string path, int width, int height, int msPerFrame, int poolSize = 8);
+
+	// waits for the encoder to write every queued frame, then closes the output
+	void stop();
+
+	bool isRunning() const;
+	int getWidth() const;
+	int getHeight() const;
+
+	// a free buffer of width * height * 4 bytes to fill with RGBA pixels, then pass to commit()
+	// returns nullptr, counting the frame as dropped, if none is free
+	unsigned char* acquire();
+
+	// queues the buffer from the last acquire() for the encoder
+	// bottomUp is true if its first row is the bottom of the image, as glReadPixels() leaves it
+	void commit(bool bottomUp);
+
+	// copies a width * height RGBA frame and queues it, returns false if it was dropped
+	bool submit(const unsigned char* rgba, bool bottomUp);
+
+	CaptureStats getStats() const;
+
+private:
+	struct Frame {
+		std::vector<unsigned char> pixels;
+		bool bottomUp;
+		long long number;
+	};
+
+	void encodeLoop();
+	bool writeFrame(const Frame& frame);
+	bool writePng(const Frame& frame);
+	bool writeY4m(const Frame& frame);
+	void writeMeasuredRate();
+
+	std::string m_path;
+	bool m_y4m;
+	int m_width;
+	int m_height;
+	std::ofstream m_video;
+	std::streampos m_rateAt;        // where the header's frame rate is, if it's to be measured, else -1
+
+	std::vector<Frame> m_frames;
+	std::vector<int> m_free;        // buffers the game loop may fill
+	std::vector<int> m_queue;       // ring of filled buffers waiting for the encoder, oldest at m_queueHead
+	int m_queueHead;
+	int m_queueSize;
+	int m_acquired;                 // buffer handed out by acquire(), or -1
+	long long m_committed;          // frames queued so far, which numbers the PNG files
+	std::chrono::steady_clock::time_point m_firstCommit;
+	std::chrono::steady_clock::time_point m_lastCommit;
+
+	// encoder's working memory, reused across frames
+	std::vector<unsigned char> m_raw;
+	std::vector<unsigned char> m_encoded;
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_ready;
+	std::thread m_encoder;
+	bool m_running;
+	bool m_stopping;
+	CaptureStats m_stats;
+};
+
+#endif // FRAMECAPTURE_H_
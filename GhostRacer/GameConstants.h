@@ -17,6 +17,7 @@ const int IID_HOLY_WATER_PROJECTILE = 7;
 const int IID_HEAL_GOODIE = 8;
 const int IID_SOUL_GOODIE = 9;
 const int IID_HOLY_WATER_GOODIE = 10;
+const int IID_ROAD = 11;	// the prerendered road background, not an actor
 
 // sounds
 
@@ -46,6 +47,14 @@ const int KEY_PRESS_ESCAPE = '\x1b';
 const int KEY_PRESS_TAB    = '\t';
 const int KEY_PRESS_ENTER  = '\r';
 
+// bits of GameWorld::getHeldKeys(), for the keys held down as a tick starts
+
+const unsigned int HELD_LEFT  = 1 << 0;
+const unsigned int HELD_RIGHT = 1 << 1;
+const unsigned int HELD_UP    = 1 << 2;
+const unsigned int HELD_DOWN  = 1 << 3;
+const unsigned int HELD_SPACE = 1 << 4;
+
 // board and sprite dimensions
 
 const int VIEW_WIDTH = 256;
@@ -62,6 +71,14 @@ const double SPRITE_HEIGHT_GL = .25; // note - this is tied implicitly to SPRITE
 const int ROAD_WIDTH = 150;
 const int ROAD_CENTER = VIEW_WIDTH / 2;
 
+const int LEFT_BOUND = ROAD_CENTER - ROAD_WIDTH / 2;       // pos of left boundary
+const int RIGHT_BOUND = ROAD_CENTER + ROAD_WIDTH / 2;      // pos of right boundary
+const int LEFT_MID_BOUND = LEFT_BOUND + ROAD_WIDTH / 3;    // pos of left middle boundary
+const int RIGHT_MID_BOUND = RIGHT_BOUND - ROAD_WIDTH / 3;  // pos of right middle boundary
+
+const int ROAD_TILE_HEIGHT = 4 * SPRITE_HEIGHT;   // the road's lines repeat this often, one white dash and gap
+const double BORDER_LINE_SIZE = 2.0;
+
 // status of each tick (did the player die?)
 
 const int GWSTATUS_PLAYER_DIED    = 0;
@@ -5,9 +5,15 @@
 #include "GraphObject.h"
 #include "SoundFX.h"
 #include "SpriteManager.h"
+#include "SpriteAssets.h"
+#include "SoftwareRenderer.h"
+#include "AssetLoader.h"
+#include "Metrics.h"
+#include "AllocStats.h"
 #include <string>
 #include <map>
 #include <utility>
+#include <cstdio>
 #include <cstdlib>
 #include <algorithm>
 using namespace std;
@@ -47,21 +53,22 @@ static const double FONT_SCALEDOWN = 760.0;
 
 static const double SCORE_Y = 3.8;
 static const double SCORE_Z = -10;
+static const double LATENCY_Y = -3.9;
+static const double TURBO_Y = -3.5;
+static const double ALLOCS_Y = -3.1;
+static const int MAX_TURBO_TICKS = 1024;
+static const int OVERLAY_TEXT_SIZE = 160;	// formatted into a buffer, so the overlays' strings only allocate when they grow
+static const int HEADLESS_KEY_FRAMES = 7;	// how often runHeadless() hits a key
 
 static const int MS_PER_FRAME = 5;
+static const int ROAD_TEXTURE_SCALE = 3;	// texels per pixel of the road tile, about one per screen pixel
 
 int GameController::m_ms_per_tick = kDefaultMsPerTick;
 
-struct SpriteInfo
-{
-	unsigned int imageID;
-	unsigned int frameNum;
-	std::string	 tgaFileName;
-};
-
 static void convertToGlutCoords(double x, double y, double& gx, double& gy, double& gz);
-static void drawPrompt(string mainMessage, string secondMessage);
-static void drawScoreAndLives(string);
+static void drawPrompt(TextAtlas& atlas, const string& mainMessage, const string& secondMessage);
+static void drawScoreAndLives(TextAtlas& atlas, const string&);
+static void outputTextCentered(TextAtlas& atlas, TextSlot slot, double y, double z, const string& str);
 
 enum GameController::GameControllerState : int {
     welcome, contgame, finishedlevel, init, cleanup, makemove, animate, gameover, prompt, quit, not_applicable
@@ -69,26 +76,6 @@ enum GameController::GameControllerState : int {
 
 void GameController::initDrawersAndSounds()
 {
-	SpriteInfo drawers[] = {
-		{ IID_GHOST_RACER	 , 0, "redcar.tga" },
-		{ IID_WHITE_BORDER_LINE	 , 0, "white-lane.tga" },
-		{ IID_YELLOW_BORDER_LINE , 0, "yellow-lane.tga" },
-		{ IID_OIL_SLICK	, 0, "oil.tga" },
-		{ IID_HUMAN_PED	, 0, "dude_1.tga" },
-		{ IID_HUMAN_PED	, 1, "dude_2.tga" },
-		{ IID_HUMAN_PED	, 2, "dude_3.tga" },
-		{ IID_ZOMBIE_PED	, 0, "zombie_1.tga" },
-		{ IID_ZOMBIE_PED	, 1, "zombie_2.tga" },
-		{ IID_ZOMBIE_PED	, 2, "zombie_3.tga" },
-		{ IID_ZOMBIE_CAB		   , 0, "yellow.tga" },
-		{ IID_HOLY_WATER_PROJECTILE	   , 0, "water1.tga" },
-		{ IID_HOLY_WATER_PROJECTILE	   , 1, "water2.tga" },
-		{ IID_HOLY_WATER_PROJECTILE	   , 2, "water3.tga" },
-		{ IID_HEAL_GOODIE  , 0, "health.tga"},
-		{ IID_HOLY_WATER_GOODIE  , 0, "holy_water.tga"},
-		{ IID_SOUL_GOODIE  , 0, "soul.tga"},
-	};
-
 	SoundMapType::value_type sounds[] = {
 		make_pair(SOUND_PED_HURT			, "hurt.wav"),
 		make_pair(SOUND_VEHICLE_HURT        ,"hurt.wav"),
@@ -105,17 +92,43 @@ void GameController::initDrawersAndSounds()
 		make_pair(SOUND_ZOMBIE_ATTACK		, "attack.wav")
 	};
 
-	for (int k = 0; k < sizeof(drawers)/sizeof(drawers[0]); k++)
+	  // sprites are read, decoded and mipmapped on worker threads, and only handed to OpenGL here
+	  // the road's lines are prerendered once, from the same decoded sprites, into a tile that's drawn as one
+	  // scrolling quad, not a sprite per line
+	SoftwareRenderer roadRenderer(ROAD_TEXTURE_SCALE);
 	{
 		string path = m_gw->assetPath();
 		if (!path.empty())
 			path += '/';
-		const SpriteInfo& d = drawers[k];
-		if (!m_spriteManager.loadSprite(path + d.tgaFileName, d.imageID, d.frameNum))
+		LoadTimings timings;
+		if (!loadSprites(SPRITE_ASSETS, NUM_SPRITE_ASSETS, path, m_spriteManager.getMaxMipSize(), 0,
+				[this, &roadRenderer](const DecodedSprite& sprite) {
+					if ((sprite.imageID == IID_YELLOW_BORDER_LINE  ||  sprite.imageID == IID_WHITE_BORDER_LINE)  &&
+						!roadRenderer.addSprite(sprite))
+						return false;
+					return m_spriteManager.uploadSprite(sprite);
+				}, timings))
 			exit(0);
+		ios::fmtflags oldFlags = cout.setf(ios::fixed, ios::floatfield);
+		streamsize oldPrecision = cout.precision(1);
+		cout << "Loaded " << timings.sprites << " sprites (" << timings.fileBytes / 1024 << " KB) in " << timings.wallMs
+			 << " ms on " << timings.threads << " threads; per sprite, summed: read " << timings.readMs << " ms, decode "
+			 << timings.decodeMs << " ms, mipmaps " << timings.mipMs << " ms; on this thread: upload " << timings.uploadMs
+			 << " ms, waiting " << timings.waitMs << " ms" << endl;
+		cout.flags(oldFlags);
+		cout.precision(oldPrecision);
 	}
+	  // whole paths, so playing a sound doesn't build one
+	string soundPath = m_gw->assetPath();
+	if (!soundPath.empty())
+		soundPath += '/';
 	for (int k = 0; k < sizeof(sounds)/sizeof(sounds[0]); k++)
-		m_soundMap[sounds[k].first] = sounds[k].second;
+		m_soundMap[sounds[k].first] = soundPath + sounds[k].second;
+
+	if (!roadRenderer.buildRoad())
+		exit(0);
+	const RgbaImage& road = roadRenderer.getRoad();
+	m_spriteManager.loadImage(IID_ROAD, 0, road.width, road.height, reinterpret_cast<const unsigned char*>(road.pixels.data()));
 }
 
 static void doSomethingCallback()
@@ -138,83 +151,273 @@ static void specialKeyboardEventCallback(int key, int x, int y)
 	Game().specialKeyboardEvent(key, x, y);
 }
 
+static void keyboardUpEventCallback(unsigned char key, int x, int y)
+{
+	Game().keyboardUpEvent(key, x, y);
+}
+
+static void specialKeyboardUpEventCallback(int key, int x, int y)
+{
+	Game().specialKeyboardUpEvent(key, x, y);
+}
+
 void GameController::timerFuncCallback(int)
 {
 	Game().doSomething();
     glutTimerFunc(MS_PER_FRAME, timerFuncCallback, 0);
 }
 
-void GameController::run(int argc, char* argv[], GameWorld* gw, string windowTitle)
+void GameController::attach(GameWorld* gw)
 {
 	gw->setController(this);
 	m_gw = gw;
-	setGameState(welcome);
-	m_lastKeyHit = INVALID_KEY;
+	m_tick = 0;
+	m_keysPerTick = 1;
+	m_keysThisTick = 0;
+	m_heldKeys = m_tickHeldKeys = 0;
+	m_showLatency = false;
+	m_showAllocs = allocStats().isReporting();
+	m_allocTextTick = -1;
+	m_turboTicks = 1;
+	m_turboTicksRun = m_turboTotalTicks = 0;
+	m_turboRate = 0;
+	m_tickShown = true;
+	m_coalesceSounds = false;
+	m_pendingSounds = 0;
 	m_singleStep = false;
-	m_curIntraFrameTick = 0;
 	m_playerWon = false;
+	m_prevRoadScroll = 0;
+
+	  // the status line and overlays are copied into these every frame, so they get their room up front
+	  // rather than growing whenever a number in them gains a digit
+	m_gameStatText.reserve(OVERLAY_TEXT_SIZE);
+	m_latencyText.reserve(OVERLAY_TEXT_SIZE);
+	m_turboText.reserve(OVERLAY_TEXT_SIZE);
+	m_allocText.reserve(OVERLAY_TEXT_SIZE);
+}
+
+void GameController::run(int argc, char* argv[], GameWorld* gw, string windowTitle)
+{
+	attach(gw);
+	setGameState(welcome);
 
 	glutInit(&argc, argv);
 
+	  // "-capture frames/shot" records a PNG sequence, "-capture run.y4m" a raw video at the rate frames were displayed
+	  // "-tick 50" simulates a tick every 50 ms, however often frames are drawn
+	  // "-keys 3" lets a tick take up to 3 queued keys, "-keys 0" all of them
+	  // "-turbo 16" starts in turbo, simulating 16 ticks a frame; '+' and '-' double and halve it while playing
+	  // "-latency keys.csv" writes how long each key took to reach the screen, and shows the overlay
+	string capturePath;
+	for (int k = 1; k + 1 < argc; k++)
+	{
+		if (string(argv[k]) == "-capture")
+			capturePath = argv[k + 1];
+		else if (string(argv[k]) == "-tick"  &&  atoi(argv[k + 1]) > 0)
+			setMsPerTick(atoi(argv[k + 1]));
+		else if (string(argv[k]) == "-keys"  &&  atoi(argv[k + 1]) >= 0)
+			setKeysPerTick(atoi(argv[k + 1]));
+		else if (string(argv[k]) == "-turbo")
+			setTurboTicks(atoi(argv[k + 1]));
+		else if (string(argv[k]) == "-latency")
+		{
+			if (m_latency.openCsv(argv[k + 1]))
+				m_showLatency = true;
+			else
+				cout << "Cannot write latencies to " << argv[k + 1] << endl;
+		}
+	}
+
 	glutInitDisplayMode(GLUT_RGB | GLUT_DEPTH | GLUT_DOUBLE);
 	glutInitWindowSize(WINDOW_WIDTH, WINDOW_HEIGHT);
 	glutInitWindowPosition(0, 0);
 	glutCreateWindow(windowTitle.c_str());
 
+	if (!capturePath.empty()  &&  !m_capture.start(capturePath, WINDOW_WIDTH, WINDOW_HEIGHT, 0))
+		cout << "Cannot capture to " << capturePath << endl;
+
 	initDrawersAndSounds();
 
 	glutKeyboardFunc(keyboardEventCallback);
 	glutSpecialFunc(specialKeyboardEventCallback);
+	glutKeyboardUpFunc(keyboardUpEventCallback);
+	glutSpecialUpFunc(specialKeyboardUpEventCallback);
 	glutReshapeFunc(reshapeCallback);
 	glutDisplayFunc(doSomethingCallback);
 	glutTimerFunc(MS_PER_FRAME, timerFuncCallback, 0);
 
 	glutSetOption(GLUT_ACTION_ON_WINDOW_CLOSE, GLUT_ACTION_GLUTMAINLOOP_RETURNS);
 	glutMainLoop();
+	if (m_capture.isRunning())
+	{
+		m_capture.stop();
+		CaptureStats stats = m_capture.getStats();
+		cout << "Captured " << stats.written << " of " << stats.submitted << " frames ("
+			 << stats.dropped << " dropped, " << stats.failed << " failed)" << endl;
+	}
 	delete m_gw;
 }
 
+  // the key the game sees for a character typed, or INVALID_KEY if it's handled by the controller
+static int translateKey(unsigned char key)
+{
+	switch (key)
+	{
+		case 'a': case '4': return KEY_PRESS_LEFT;
+		case 'd': case '6': return KEY_PRESS_RIGHT;
+		case 'w': case '8': return KEY_PRESS_UP;
+		case 's': case '2': return KEY_PRESS_DOWN;
+		case 't':			return KEY_PRESS_TAB;
+		case 'f': case 'r': case 'l': case 'm': case '+': case '=': case '-': case 'q': case 'Q': return INVALID_KEY;
+		default:			return key;
+	}
+}
+
+static int translateSpecialKey(int key)
+{
+	switch (key)
+	{
+		case GLUT_KEY_LEFT:	 return KEY_PRESS_LEFT;
+		case GLUT_KEY_RIGHT: return KEY_PRESS_RIGHT;
+		case GLUT_KEY_UP:	 return KEY_PRESS_UP;
+		case GLUT_KEY_DOWN:	 return KEY_PRESS_DOWN;
+		default:			 return INVALID_KEY;
+	}
+}
+
+static unsigned int heldBit(int key)
+{
+	switch (key)
+	{
+		case KEY_PRESS_LEFT:  return HELD_LEFT;
+		case KEY_PRESS_RIGHT: return HELD_RIGHT;
+		case KEY_PRESS_UP:	  return HELD_UP;
+		case KEY_PRESS_DOWN:  return HELD_DOWN;
+		case KEY_PRESS_SPACE: return HELD_SPACE;
+		default:			  return 0;
+	}
+}
+
 void GameController::keyboardEvent(unsigned char key, int /* x */, int /* y */)
 {
 	switch (key)
 	{
-		case 'a': case '4': m_lastKeyHit = KEY_PRESS_LEFT;	break;
-		case 'd': case '6': m_lastKeyHit = KEY_PRESS_RIGHT; break;
-		case 'w': case '8': m_lastKeyHit = KEY_PRESS_UP;	break;
-		case 's': case '2': m_lastKeyHit = KEY_PRESS_DOWN;	break;
-		case 't':			m_lastKeyHit = KEY_PRESS_TAB;	break;
 		case 'f':			m_singleStep = true;			break;
 		case 'r':			m_singleStep = false;			break;
+		case 'l':			m_showLatency = !m_showLatency;	break;
+		case 'm':			m_showAllocs = !m_showAllocs;	break;
+		case '+': case '=': setTurboTicks(m_turboTicks * 2);	break;
+		case '-':			setTurboTicks(m_turboTicks / 2);	break;
 		case 'q': case 'Q': setGameState(quit);				break;
-		default:			m_lastKeyHit = key;				break;
+		default:			pushKey(translateKey(key));		break;
 	}
 }
 
 void GameController::specialKeyboardEvent(int key, int /* x */, int /* y */)
 {
-	switch (key)
-	{
-		case GLUT_KEY_LEFT:	 m_lastKeyHit = KEY_PRESS_LEFT;	 break;
-		case GLUT_KEY_RIGHT: m_lastKeyHit = KEY_PRESS_RIGHT; break;
-		case GLUT_KEY_UP:	 m_lastKeyHit = KEY_PRESS_UP;	 break;
-		case GLUT_KEY_DOWN:	 m_lastKeyHit = KEY_PRESS_DOWN;	 break;
-		default:			 m_lastKeyHit = INVALID_KEY;	 break;
-	}
+	pushKey(translateSpecialKey(key));
+}
+
+void GameController::keyboardUpEvent(unsigned char key, int /* x */, int /* y */)
+{
+	setHeld(translateKey(key), false);
+}
+
+void GameController::specialKeyboardUpEvent(int key, int /* x */, int /* y */)
+{
+	setHeld(translateSpecialKey(key), false);
+}
+
+void GameController::pushKey(int key)
+{
+	if (key == INVALID_KEY)
+		return;
+	setHeld(key, true);
+	  // it's for the next tick to start, the current one having already been simulated
+	m_input.push(key, m_tick + 1);
+}
+
+void GameController::setHeld(int key, bool down)
+{
+	if (down)
+		m_heldKeys |= heldBit(key);
+	else
+		m_heldKeys &= ~heldBit(key);
+}
+
+bool GameController::getTickKey(int& value)
+{
+	if (m_keysPerTick > 0  &&  m_keysThisTick >= m_keysPerTick)
+		return false;
+	InputEvent e;
+	if (!m_input.peek(e)  ||  e.tick > m_tick)
+		return false;
+	m_input.pop(e);
+	m_latency.keyTaken(e);
+	m_keysThisTick++;
+	value = e.key;
+	return true;
 }
 
 void GameController::playSound(int soundID)
 {
 	if (soundID == SOUND_NONE)
 		return;
+	if (m_coalesceSounds  &&  soundID >= 0  &&  soundID < 32)
+	{
+		if (m_pendingSounds & (1u << soundID))
+			metrics().soundDropped();
+		m_pendingSounds |= 1u << soundID;
+		return;
+	}
 
 	SoundMapType::const_iterator p = m_soundMap.find(soundID);
 	if (p != m_soundMap.end())
 	{
-		string path = m_gw->assetPath();
-		if (!path.empty())
-			path += '/';
-		SoundFX().playClip(path + p->second);
+		SoundFX().playClip(p->second);
+		metrics().soundPlayed();
+	}
+	else
+		metrics().soundDropped();
+}
+
+void GameController::flushSounds()
+{
+	m_coalesceSounds = false;
+	for (int soundID = 0; m_pendingSounds != 0; soundID++, m_pendingSounds >>= 1)
+	{
+		if (m_pendingSounds & 1)
+			playSound(soundID);
+	}
+}
+
+void GameController::setTurboTicks(int ticks)
+{
+	ticks = min(max(ticks, 1), MAX_TURBO_TICKS);
+	chrono::steady_clock::time_point now = chrono::steady_clock::now();
+	if (m_turboTicks > 1  &&  ticks == 1)
+	{
+		chrono::duration<double> elapsed = now - m_turboStart;
+		cout << "Turbo: " << m_turboTotalTicks + m_turboTicksRun << " ticks in " << elapsed.count() << " s ("
+			 << (m_turboTotalTicks + m_turboTicksRun) / max(elapsed.count(), 1e-9) << " ticks/s)" << endl;
+	}
+	else if (m_turboTicks == 1  &&  ticks > 1)
+	{
+		m_turboStart = m_turboWindowStart = now;
+		m_turboTotalTicks = 0;
+		m_turboTicksRun = 0;
+		m_turboRate = 0;
 	}
+	m_turboTicks = ticks;
+	m_turboText.clear();
+}
+
+void GameController::drawTurbo()
+{
+	if (m_turboTicks <= 1)
+		return;
+	glColor3f(0.4f, 1.0f, 0.4f);
+	outputTextCentered(m_textAtlas, TEXT_TURBO, TURBO_Y, SCORE_Z, m_turboText);
 }
 
 void GameController::setGameState(GameControllerState s)
@@ -253,29 +456,20 @@ void GameController::doSomething()
 			m_nextStateAfterPrompt = cleanup;
 			break;
 		case makemove:
-			m_curIntraFrameTick = ANIMATION_POSITIONS_PER_TICK;
-			m_nextStateAfterAnimate = not_applicable;
-			{
-				int status = m_gw->move();
-				if (status == GWSTATUS_PLAYER_DIED)
-				{
-					  // animate one last frame so the Ego can see what happened
-					m_nextStateAfterAnimate = (m_gw->isGameOver() ? gameover : contgame);
-				}
-				else if (status == GWSTATUS_FINISHED_LEVEL)
-				{
-					m_gw->advanceToNextLevel();
-					  // animate one last frame so the Ego can see what happened
-					m_nextStateAfterAnimate = finishedlevel;
-				}
-			}
+			simulateTicks();
 			setGameState(animate);
 			break;
 		case animate:
-			displayGamePlay();
-			if (m_curIntraFrameTick-- <= 0)
 			{
-				if (m_nextStateAfterAnimate != not_applicable)
+				  // draw every frame the timer gives us, and simulate the next tick once this one's time is up
+				  // in turbo, the next batch runs as soon as this frame is drawn
+				double alpha = (m_turboTicks > 1 ? 1 : tickAlpha());
+				displayGamePlay(alpha);
+				if (alpha < 1)
+					break;
+				if (m_turboTicks > 1  &&  (m_nextStateAfterAnimate == contgame  ||  m_nextStateAfterAnimate == finishedlevel))
+					setGameState(cleanup);		// turbo doesn't stop to ask between lives and levels
+				else if (m_nextStateAfterAnimate != not_applicable)
 					setGameState(m_nextStateAfterAnimate);
 				else
 				{
@@ -301,7 +495,7 @@ void GameController::doSomething()
 			m_nextStateAfterPrompt = quit;
 			break;
 		case prompt:
-			drawPrompt(m_mainMessage, m_secondMessage);
+			drawPrompt(m_textAtlas, m_mainMessage, m_secondMessage);
 			{
 				int key;
 				if (getLastKey(key) && key == '\r')
@@ -335,9 +529,113 @@ void GameController::doSomething()
 	}
 }
 
+void GameController::simulateTicks()
+{
+	m_nextStateAfterAnimate = not_applicable;
 
-void GameController::displayGamePlay()
+	  // in turbo, m_turboTicks ticks for every frame drawn, with only the last one's HUD formatted
+	  // and the batch's sounds each played once at the end
+	int ticks = max(m_turboTicks, 1);
+	m_coalesceSounds = (ticks > 1);
+	for (int k = 0; k < ticks  &&  m_nextStateAfterAnimate == not_applicable; k++)
+	{
+		AllocTick allocTick;
+		m_tickShown = (k == ticks - 1);
+		startTick();
+		int status = m_gw->move();
+		m_turboTicksRun++;
+		if (status == GWSTATUS_PLAYER_DIED)
+		{
+			  // animate one last frame so the Ego can see what happened
+			m_nextStateAfterAnimate = (m_gw->isGameOver() ? gameover : contgame);
+		}
+		else if (status == GWSTATUS_FINISHED_LEVEL)
+		{
+			m_gw->advanceToNextLevel();
+			  // animate one last frame so the Ego can see what happened
+			m_nextStateAfterAnimate = finishedlevel;
+		}
+	}
+	m_tickShown = true;
+	flushSounds();
+}
+
+void GameController::runHeadless(GameWorld* gw, int frames, int turboTicks)
 {
+	attach(gw);
+	m_showLatency = m_showAllocs = true;
+	setTurboTicks(turboTicks);
+	m_gw->init();
+	for (int frame = 0; frame < frames; frame++)
+	{
+		  // the whole frame counts as one tick, the ones it simulates being nested in it
+		AllocTick allocTick;
+		if (frame % HEADLESS_KEY_FRAMES == 0)
+			pushKey(frame / HEADLESS_KEY_FRAMES % 2 == 0 ? KEY_PRESS_LEFT : KEY_PRESS_RIGHT);
+		else if (frame % HEADLESS_KEY_FRAMES == 1)
+			m_heldKeys = 0;
+
+		simulateTicks();
+
+		  // what displayGamePlay() does besides drawing
+		m_gw->syncDrawnPositions();
+		m_latency.frameStarted();
+		updateOverlayText();
+		m_latency.frameShown();
+
+		  // no prompts between lives and levels, as in turbo
+		if (m_nextStateAfterAnimate != not_applicable)
+		{
+			m_gw->cleanUp();
+			m_gw->init();
+		}
+	}
+	m_gw->cleanUp();
+	gw->setController(nullptr);
+	m_gw = nullptr;
+	m_turboTicks = 1;
+}
+
+void GameController::startTick()
+{
+	  // ticks start m_ms_per_tick apart, unless the game fell a tick or more behind (a prompt, single stepping,
+	  // a slow frame), in which case it carries on from now rather than rushing to catch up
+	chrono::steady_clock::time_point now = chrono::steady_clock::now();
+	chrono::milliseconds period(m_ms_per_tick);
+	m_tick++;
+	m_keysThisTick = 0;
+	m_tickHeldKeys = m_heldKeys;
+	m_tickStart += period;
+	if (now - m_tickStart >= period  ||  now < m_tickStart)
+		m_tickStart = now;
+
+	  // where everything is now is where this tick's frames interpolate from
+	for (int i = 0; i < 4 /* NUM_DEPTHS */; ++i)
+	{
+		GraphObject::DepthList& graphObjects = GraphObject::getGraphObjects(i);
+		for (auto it = graphObjects.begin(); it != graphObjects.end(); it++)
+			(*it)->savePreviousLocation();
+	}
+	m_prevRoadScroll = m_gw->getRoadScroll();
+}
+
+double GameController::tickAlpha() const
+{
+	chrono::duration<double, milli> elapsed = chrono::steady_clock::now() - m_tickStart;
+	return min(max(elapsed.count() / m_ms_per_tick, 0.0), 1.0);
+}
+
+void GameController::displayGamePlay(double alpha)
+{
+	const ::fixed fixedAlpha = toFixed(alpha);
+	m_gw->syncDrawnPositions();
+	  // keys are only stamped on the frame that shows all of their tick's motion, as frames before it are still
+	  // catching up from where everything was before the tick, and would report a key as shown too early
+	const bool tickComplete = (alpha >= 1);
+	if (tickComplete)
+		m_latency.frameStarted();
+	metrics().frameDrawn();
+	m_textAtlas.build();	// first frame only, before the clear below
 	glEnable(GL_DEPTH_TEST); // must be done each time before displaying graphics or gets disabled for some reason
 	glLoadIdentity();
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -350,22 +648,36 @@ void GameController::displayGamePlay()
 #pragma GCC diagnostic pop
 #endif
 
+	  // the road goes behind everything, scrolled by how far the world has moved
+	{
+		double gx1, gy1, gx2, gy2, gz;
+		convertToGlutCoords(0, 0, gx1, gy1, gz);
+		convertToGlutCoords(VIEW_WIDTH, VIEW_HEIGHT, gx2, gy2, gz);
+		double scroll = m_gw->getRoadScroll() - m_prevRoadScroll;	// how far the last tick moved it, the short way round the tile
+		if (scroll > ROAD_TILE_HEIGHT / 2)
+			scroll -= ROAD_TILE_HEIGHT;
+		else if (scroll < -ROAD_TILE_HEIGHT / 2)
+			scroll += ROAD_TILE_HEIGHT;
+		double t1 = (m_prevRoadScroll + alpha * scroll) / ROAD_TILE_HEIGHT;
+		m_spriteManager.plotScrolling(IID_ROAD, gx1, gy1, gx2, gy2, gz, t1, t1 + static_cast<double>(VIEW_HEIGHT) / ROAD_TILE_HEIGHT);
+	}
+
 	for (int i = 4 /* NUM_DEPTHS */ - 1; i >= 0; --i)
 	{
-		std::set<GraphObject*> &graphObjects = GraphObject::getGraphObjects(i);
+		GraphObject::DepthList& graphObjects = GraphObject::getGraphObjects(i);
 
 		for (auto it = graphObjects.begin(); it != graphObjects.end(); it++)
 		{
 			GraphObject* cur = *it;
 			if (cur->isVisible())
 			{
-				cur->animate();
+				cur->animate(fixedAlpha);
 
 				double x, y, gx, gy, gz;
 				cur->getAnimationLocation(x, y);
 				convertToGlutCoords(x, y, gx, gy, gz);
 
-				int angle = cur->getDirection();
+				int angle = cur->getAnimationDirection();
 				int imageID = cur->getID();
 
 				m_spriteManager.plotSprite(imageID, cur->getAnimationNumber() % m_spriteManager.getNumFrames(imageID), gx, gy, gz, angle, cur->getSize());
@@ -373,9 +685,93 @@ void GameController::displayGamePlay()
 		}
 	}
 
-	drawScoreAndLives(m_gameStatText);
+	drawScoreAndLives(m_textAtlas, m_gameStatText);
+	updateOverlayText();
+	drawLatency();
+	drawTurbo();
+	drawAllocs();
 
+	captureFrame();
 	glutSwapBuffers();
+	if (tickComplete)
+		m_latency.frameShown();
+}
+
+void GameController::updateOverlayText()
+{
+	char text[OVERLAY_TEXT_SIZE];
+
+	  // latency, formatted only when a key has been shown since
+	if (m_showLatency  &&  (m_latency.hasNewSamples()  ||  m_latencyText.empty()))
+	{
+		LatencySummary summary = m_latency.getSummary();
+		snprintf(text, sizeof(text), "Key to screen p50 %.1f  p95 %.1f  max %.1f ms (%d keys)",
+			summary.p50, summary.p95, summary.max, summary.samples);
+		m_latencyText = text;
+	}
+
+	  // the turbo rate over the last second or so, formatted only when it changes
+	if (m_turboTicks > 1)
+	{
+		chrono::steady_clock::time_point now = chrono::steady_clock::now();
+		chrono::duration<double> window = now - m_turboWindowStart;
+		if (window.count() >= 1)
+		{
+			m_turboRate = m_turboTicksRun / window.count();
+			m_turboTotalTicks += m_turboTicksRun;
+			m_turboTicksRun = 0;
+			m_turboWindowStart = now;
+			m_turboText.clear();
+		}
+		if (m_turboText.empty())
+		{
+			snprintf(text, sizeof(text), "Turbo x%d: %lld ticks/s  (+/- to change)", m_turboTicks, static_cast<long long>(m_turboRate + 0.5));
+			m_turboText = text;
+		}
+	}
+
+	  // heap use, formatted only when a tick has run since
+	AllocStats& stats = allocStats();
+	if (m_showAllocs  &&  (stats.getTicks() != m_allocTextTick  ||  m_allocText.empty()))
+	{
+		AllocCounts total = stats.getTotal();
+		const AllocTickCounts& tick = stats.getLastTick();
+		snprintf(text, sizeof(text), "Heap %lld KB (peak %lld)  tick %lld allocs %lld frees  warm ticks allocating %lld/%lld",
+			total.liveBytes / 1024, total.peakBytes / 1024, tick.allocs, tick.frees,
+			stats.getWarmTicksAllocating(), stats.getWarmTicks());
+		m_allocText = text;
+		m_allocTextTick = stats.getTicks();
+	}
+}
+
+void GameController::drawLatency()
+{
+	if (!m_showLatency)
+		return;
+	glColor3f(1.0f, 1.0f, 0.4f);
+	outputTextCentered(m_textAtlas, TEXT_LATENCY, LATENCY_Y, SCORE_Z, m_latencyText);
+}
+
+void GameController::drawAllocs()
+{
+	if (!m_showAllocs)
+		return;
+	glColor3f(1.0f, 0.6f, 0.6f);
+	outputTextCentered(m_textAtlas, TEXT_ALLOCS, ALLOCS_Y, SCORE_Z, m_allocText);
+}
+
+void GameController::captureFrame()
+{
+	if (!m_capture.isRunning())
+		return;
+
+	  // read the back buffer just before it's swapped, since it's undefined after
+	unsigned char* pixels = m_capture.acquire();
+	if (pixels == nullptr)
+		return;
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, m_capture.getWidth(), m_capture.getHeight(), GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+	m_capture.commit(true);
 }
 
 void GameController::reshape (int w, int h)
@@ -432,17 +828,27 @@ static void outputStrokeCentered(double y, double z, const char* str)
 	doOutputStroke(0, y, z, 1, str, true);
 }
 
-static void drawPrompt(string mainMessage, string secondMessage)
+  // from the glyph atlas, or stroked if it couldn't be built
+static void outputTextCentered(TextAtlas& atlas, TextSlot slot, double y, double z, const string& str)
+{
+	if (atlas.isBuilt())
+		atlas.drawCentered(slot, str, y, z, FONT_SCALEDOWN);
+	else
+		outputStrokeCentered(y, z, str.c_str());
+}
+
+static void drawPrompt(TextAtlas& atlas, const string& mainMessage, const string& secondMessage)
 {
+	atlas.build();	// first frame only, before the clear below
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 	glColor3f (1.0, 1.0, 1.0);
 	glLoadIdentity ();
-	outputStrokeCentered(1, -5, mainMessage.c_str());
-	outputStrokeCentered(-1, -5, secondMessage.c_str());
+	outputTextCentered(atlas, TEXT_PROMPT_MAIN, 1, -5, mainMessage);
+	outputTextCentered(atlas, TEXT_PROMPT_SECOND, -1, -5, secondMessage);
 	glutSwapBuffers();
 }
 
-static void drawScoreAndLives(string gameStatText)
+static void drawScoreAndLives(TextAtlas& atlas, const string& gameStatText)
 {
 	static int RATE = 1;
 	static GLfloat rgb[3] =
@@ -457,5 +863,5 @@ static void drawScoreAndLives(string gameStatText)
 		rgb[k] = static_cast<GLfloat>(strength);
 	}
 	glColor3f(rgb[0], rgb[1], rgb[2]);
-	outputStrokeCentered(SCORE_Y, SCORE_Z, gameStatText.c_str());
+	outputTextCentered(atlas, TEXT_HUD, SCORE_Y, SCORE_Z, gameStatText);
 }
@@ -2,6 +2,11 @@
 #define GAMECONTROLLER_H_
 
 #include "SpriteManager.h"
+#include "FrameCapture.h"
+#include "TextAtlas.h"
+#include "InputQueue.h"
+#include "LatencyMonitor.h"
+#include <chrono>
 #include <string>
 #include <map>
 #include <iostream>
@@ -16,20 +21,44 @@ class GameController
   public:
 	void run(int argc, char* argv[], GameWorld* gw, std::string windowTitle);
 
+	  // The oldest key hit that hasn't been taken yet, for prompts and single stepping
 	bool getLastKey(int& value)
 	{
-		if (m_lastKeyHit != INVALID_KEY)
-		{
-			value = m_lastKeyHit;
-			m_lastKeyHit = INVALID_KEY;
-			return true;
-		}
-		return false;
+		InputEvent e;
+		if (!m_input.pop(e))
+			return false;
+		value = e.key;
+		return true;
+	}
+
+	  // The oldest key for the tick being simulated, until the tick has had its m_keysPerTick
+	  // keys left over stay queued, in order, for the ticks after
+	bool getTickKey(int& value);
+
+	  // Which keys (HELD_* bits) were held down when the tick being simulated started
+	unsigned int getHeldKeys() const
+	{
+		return m_tickHeldKeys;
+	}
+
+	  // How many keys a tick may take, 0 for every one that's queued
+	void setKeysPerTick(int keys_per_tick)
+	{
+		m_keysPerTick = keys_per_tick;
+	}
+
+	  // Simulate this many ticks for every frame drawn (1 is normal speed), printing the ticks/s achieved when turbo ends
+	void setTurboTicks(int ticks);
+
+	  // Whether the tick being simulated is one a frame will show, as turbo skips drawing the others
+	bool isTickShown() const
+	{
+		return m_tickShown;
 	}
 
 	void playSound(int soundID);
 
-	void setGameStatText(std::string text)
+	void setGameStatText(const std::string& text)
 	{
 		m_gameStatText = text;
 	}
@@ -39,6 +68,8 @@ class GameController
 	void reshape(int w, int h);
 	void keyboardEvent(unsigned char key, int x, int y);
 	void specialKeyboardEvent(int key, int x, int y);
+	void keyboardUpEvent(unsigned char key, int x, int y);
+	void specialKeyboardUpEvent(int key, int x, int y);
 
     void quitGame();
 
@@ -49,6 +80,11 @@ class GameController
 		return instance;
 	}
 
+	  // Plays frames frames of gw with no window, doing each frame's ticks and bookkeeping (keys, held keys,
+	  // latency, coalesced sounds, status and overlay text) as run() would, but drawing and playing nothing,
+	  // a key being hit every few frames; each frame is one AllocStats tick, so -alloccheck covers all of it
+	void runHeadless(GameWorld* gw, int frames, int turboTicks);
+
 	static void timerFuncCallback(int nothing);
 	void setMsPerTick(int ms_per_tick) { m_ms_per_tick = ms_per_tick;  }
 
@@ -59,24 +95,64 @@ private:
 	GameControllerState	m_gameState;
 	GameControllerState	m_nextStateAfterPrompt;
 	GameControllerState	m_nextStateAfterAnimate;
-	int			m_lastKeyHit;
+	InputQueue	m_input;
+	unsigned int m_tick;			// how many ticks have started
+	int			m_keysPerTick;
+	int			m_keysThisTick;
+	unsigned int m_heldKeys;		// HELD_* bits for the keys down now
+	unsigned int m_tickHeldKeys;	// and when the tick started
+	LatencyMonitor m_latency;		// from each key hit to the frame showing it
+	bool		m_showLatency;		// 'l' toggles the overlay
+	std::string m_latencyText;
+	int			m_turboTicks;		// ticks simulated per frame drawn, 1 when turbo is off
+	bool		m_tickShown;		// whether the tick being simulated is the one the next frame shows
+	bool		m_coalesceSounds;	// while a turbo batch runs, sounds are collected in m_pendingSounds
+	unsigned int m_pendingSounds;	// one bit per sound ID
+	std::chrono::steady_clock::time_point m_turboStart;
+	std::chrono::steady_clock::time_point m_turboWindowStart;
+	long long	m_turboTicksRun;	// since the window started
+	long long	m_turboTotalTicks;	// in earlier windows
+	double		m_turboRate;		// ticks/s over the last window
+	std::string m_turboText;
+	bool		m_showAllocs;		// the heap overlay, 'm' toggles
+	long long	m_allocTextTick;	// AllocStats tick m_allocText was formatted for
+	std::string m_allocText;
 	bool		m_singleStep;
 	std::string m_gameStatText;
 	std::string m_mainMessage;
 	std::string m_secondMessage;
-	int			m_curIntraFrameTick;
+	std::chrono::steady_clock::time_point m_tickStart;	// when the tick being displayed began
+	double		m_prevRoadScroll;	// the road's scroll before that tick
 	using SoundMapType = std::map<int, std::string>;
 	using DrawMapType  = std::map<int, std::string>;
 	SoundMapType m_soundMap;
 	bool		m_playerWon;
 	SpriteManager m_spriteManager;
+	FrameCapture m_capture;		// records each displayed frame when run with -capture
+	TextAtlas	m_textAtlas;
 
     void setGameState(GameControllerState s);
 
+	void attach(GameWorld* gw);
 	void initDrawersAndSounds();
-	void displayGamePlay();
-
-	static const int kDefaultMsPerTick = 10;
+	  // the ticks for one frame, m_turboTicks of them in turbo, setting m_nextStateAfterAnimate if the last ends a life or level
+	void simulateTicks();
+	void startTick();
+	void pushKey(int key);
+	void setHeld(int key, bool down);
+	  // how far through the current tick the clock is, from 0 to 1
+	double tickAlpha() const;
+	void displayGamePlay(double alpha);
+	void captureFrame();
+	  // formats the overlays' text, when it has changed, for the draw functions below
+	void updateOverlayText();
+	void drawLatency();
+	void drawTurbo();
+	void drawAllocs();
+	void flushSounds();
+
+	  // the pace the game has always run at, three timer frames a tick
+	static const int kDefaultMsPerTick = 15;
 	static int m_ms_per_tick;
 };
 
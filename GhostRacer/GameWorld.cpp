@@ -1,12 +1,19 @@
 #include "GameWorld.h"
 #include "GameController.h"
+#include "AllocStats.h"
 #include <string>
 #include <cstdlib>
 using namespace std;
 
+  // With no controller attached (headless runs such as benchmarks) there is
+  // no keyboard, sound, or status line, so these do nothing.
+
 bool GameWorld::getKey(int& value)
 {
-	bool gotKey = m_controller->getLastKey(value);
+	if (m_controller == nullptr)
+		return false;
+
+	bool gotKey = m_controller->getTickKey(value);
 
 	if (gotKey)
 	{
@@ -18,15 +25,43 @@ bool GameWorld::getKey(int& value)
 
 void GameWorld::playSound(int soundID)
 {
+	if (m_controller == nullptr)
+		return;
 	m_controller->playSound(soundID);
 }
 
-void GameWorld::setGameStatText(string text)
+bool GameWorld::isTickShown() const
+{
+	if (m_controller == nullptr)
+		return false;
+	return m_controller->isTickShown();
+}
+
+void GameWorld::setGameStatText(const string& text)
 {
+	if (m_controller == nullptr)
+		return;
+	AllocScope scope(ALLOC_STATUS_TEXT);	// only while the controller's copy grows
 	m_controller->setGameStatText(text);
 }
 
 void GameWorld::setMsPerTick(int ms_per_tick)
 {
+	if (m_controller == nullptr)
+		return;
 	m_controller->setMsPerTick(ms_per_tick);
 }
+
+unsigned int GameWorld::getHeldKeys() const
+{
+	if (m_controller == nullptr)
+		return 0;
+	return m_controller->getHeldKeys();
+}
+
+void GameWorld::setKeysPerTick(int keys_per_tick)
+{
+	if (m_controller == nullptr)
+		return;
+	m_controller->setKeysPerTick(keys_per_tick);
+}
@@ -26,11 +26,18 @@ public:
 	virtual int move() = 0;
 	virtual void cleanUp() = 0;
 
-	void setGameStatText(std::string text);
+	void setGameStatText(const std::string& text);
 
+	  // the oldest key hit that this tick can still take (one by default, see setKeysPerTick())
 	bool getKey(int& value);
+	  // HELD_* bits for the keys that were held down as this tick started
+	unsigned int getHeldKeys() const;
+
 	void playSound(int soundID);
 
+	  // false for ticks no frame will show (turbo runs several per frame), so there's no need to update the status line
+	bool isTickShown() const;
+
 	int getLevel() const
 	{
 		return m_level;
@@ -63,6 +70,17 @@ public:
 
 	  // The following should be used by only the framework, not the student
 
+	  // How far the road background has scrolled down, in pixels, for drawing it
+	virtual double getRoadScroll() const
+	{
+		return 0;
+	}
+
+	  // Bring every GraphObject up to date with the last tick, just before a frame is drawn
+	virtual void syncDrawnPositions()
+	{
+	}
+
 	bool isGameOver() const
 	{
 		return m_lives == 0;
@@ -78,12 +96,13 @@ public:
 		m_controller = controller;
 	}
 
-	std::string assetPath() const
+	const std::string& assetPath() const
 	{
 		return m_assetPath;
 	}
 
 	void setMsPerTick(int ms_per_tick);
+	void setKeysPerTick(int keys_per_tick);
 private:
 	int				m_lives;
 	int				m_score;
@@ -0,0 +1,198 @@
+#include "GameplayLog.h"
+#include "Fixed.h"
+#include <chrono>
+#include <cstring>
+#include <iostream>
+using namespace std;
+
+static_assert(sizeof(GameplayRecord) == 20, "records are written to the file as they are in memory");
+
+static const char GAMEPLAY_LOG_MAGIC[4] = { 'G', 'R', 'L', 'G' };
+static const uint32_t GAMEPLAY_LOG_VERSION = 2;	// 2: a death's value is why it died, not the damage
+
+static const char* const GAMEPLAY_EVENT_NAMES[NUM_GAMEPLAY_EVENT_TYPES] = {
+	"spawn", "death", "damage", "score", "soul_saved", "spray_fired", "level_started", "level_finished"
+};
+
+// chrono::milliseconds(FLUSH_MS) binds it by reference, so it needs a definition
+const int GameplayLog::FLUSH_MS;
+
+GameplayLog::Ring::Ring()
+	: head(0), tail(0) {
+}
+
+GameplayLog::GameplayLog()
+	: m_open(false), m_stopping(false), m_written(0), m_dropped(0) {
+}
+
+GameplayLog::~GameplayLog() {
+	close();
+}
+
+bool GameplayLog::open(string path) {
+	if (isOpen())
+		return false;
+	m_file.open(path, ios::out | ios::binary | ios::trunc);
+	if (!m_file)
+		return false;
+
+	GameplayLogHeader header;
+	memcpy(header.magic, GAMEPLAY_LOG_MAGIC, sizeof(header.magic));
+	header.version = GAMEPLAY_LOG_VERSION;
+	header.recordSize = sizeof(GameplayRecord);
+	header.reserved = 0;
+	m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	{
+		// anything left in a ring from an earlier file was logged as that one closed
+		lock_guard<mutex> lock(m_mutex);
+		for (unique_ptr<Ring>& ring : m_rings)
+			ring->head.store(ring->tail.load(memory_order_acquire), memory_order_relaxed);
+		m_stopping = false;
+	}
+	m_written = 0;
+	m_dropped = 0;
+	m_writer = thread(&GameplayLog::writerLoop, this);
+	m_open.store(true, memory_order_release);
+	return true;
+}
+
+void GameplayLog::close() {
+	if (!isOpen())
+		return;
+	m_open.store(false, memory_order_release);
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_wake.notify_one();
+	m_writer.join();
+
+	// whatever was logged after the writer's last pass
+	for (unique_ptr<Ring>& ring : m_rings)
+		drain(*ring);
+	m_file.close();
+	if (m_dropped > 0)
+		cout << "Gameplay log dropped " << m_dropped << " of " << m_written + m_dropped << " records" << endl;
+}
+
+long long GameplayLog::getWritten() const {
+	return m_written.load(memory_order_relaxed);
+}
+
+long long GameplayLog::getDropped() const {
+	return m_dropped.load(memory_order_relaxed);
+}
+
+void GameplayLog::append(unsigned int tick, GameplayEventType type, int actorType, int32_t x, int32_t y, int32_t value) {
+	Ring& ring = *threadRing();
+	const unsigned int tail = ring.tail.load(memory_order_relaxed);
+	if (tail - ring.head.load(memory_order_acquire) == RING_CAPACITY) {
+		m_dropped.fetch_add(1, memory_order_relaxed);
+		return;
+	}
+	GameplayRecord& r = ring.records[tail % RING_CAPACITY];
+	r.tick = tick;
+	r.type = static_cast<uint8_t>(type);
+	r.actorType = static_cast<int8_t>(actorType);
+	r.reserved = 0;
+	r.x = x;
+	r.y = y;
+	r.value = value;
+	// publishes the record to the writer
+	ring.tail.store(tail + 1, memory_order_release);
+}
+
+GameplayLog::Ring* GameplayLog::threadRing() {
+	// each thread registers a ring the first time it logs, and keeps it for the log's lifetime
+	static thread_local GameplayLog* owner = nullptr;
+	static thread_local Ring* ring = nullptr;
+	if (owner != this) {
+		lock_guard<mutex> lock(m_mutex);
+		m_rings.emplace_back(new Ring);
+		ring = m_rings.back().get();
+		owner = this;
+	}
+	return ring;
+}
+
+void GameplayLog::writerLoop() {
+	unique_lock<mutex> lock(m_mutex);
+	while (!m_stopping) {
+		m_wake.wait_for(lock, chrono::milliseconds(FLUSH_MS));
+		// holding the lock only keeps m_rings from growing under us; producers never take it once registered
+		for (unique_ptr<Ring>& ring : m_rings)
+			drain(*ring);
+		m_file.flush();
+	}
+}
+
+void GameplayLog::drain(Ring& ring) {
+	// head and tail count up forever and wrap around unsigned, like InputQueue's
+	const unsigned int head = ring.head.load(memory_order_relaxed);
+	const unsigned int tail = ring.tail.load(memory_order_acquire);
+	const unsigned int count = tail - head;
+	if (count == 0)
+		return;
+
+	// at most two contiguous runs, either side of the end of the ring
+	const unsigned int first = head % RING_CAPACITY;
+	const unsigned int run = (count < RING_CAPACITY - first ? count : RING_CAPACITY - first);
+	m_file.write(reinterpret_cast<const char*>(ring.records + first), run * sizeof(GameplayRecord));
+	if (run < count)
+		m_file.write(reinterpret_cast<const char*>(ring.records), (count - run) * sizeof(GameplayRecord));
+
+	// hands the slots back to the producer
+	ring.head.store(tail, memory_order_release);
+	m_written.fetch_add(count, memory_order_relaxed);
+}
+
+GameplayLog& gameplayLog() {
+	static GameplayLog log;
+	return log;
+}
+
+int convertGameplayLog(string in, string out) {
+	ifstream ifs(in, ios::in | ios::binary);
+	if (!ifs) {
+		cout << "Cannot open " << in << endl;
+		return 1;
+	}
+	GameplayLogHeader header;
+	if (!ifs.read(reinterpret_cast<char*>(&header), sizeof(header)) || memcmp(header.magic, GAMEPLAY_LOG_MAGIC, 4) != 0
+		|| header.version != GAMEPLAY_LOG_VERSION || header.recordSize != sizeof(GameplayRecord)) {
+		cout << in << " is not a version " << GAMEPLAY_LOG_VERSION << " gameplay log" << endl;
+		return 1;
+	}
+	ofstream ofs(out, ios::out | ios::trunc);
+	if (!ofs) {
+		cout << "Cannot write " << out << endl;
+		return 1;
+	}
+
+	// records are converted a block at a time
+	const int BLOCK = 4096;
+	vector<GameplayRecord> records(BLOCK);
+	long long converted = 0;
+	ofs << "tick,event,actor_type,x,y,value\n";
+	for (;;) {
+		ifs.read(reinterpret_cast<char*>(records.data()), BLOCK * sizeof(GameplayRecord));
+		const int n = static_cast<int>(ifs.gcount() / sizeof(GameplayRecord));
+		for (int k = 0; k < n; ++k) {
+			const GameplayRecord& r = records[k];
+			ofs << r.tick << ',';
+			if (r.type < NUM_GAMEPLAY_EVENT_TYPES)
+				ofs << GAMEPLAY_EVENT_NAMES[r.type];
+			else
+				ofs << static_cast<int>(r.type);
+			ofs << ',' << static_cast<int>(r.actorType) << ',' << fromFixed(r.x) << ',' << fromFixed(r.y) << ',' << r.value << '\n';
+		}
+		converted += n;
+		if (n < BLOCK)
+			break;
+	}
+	if (ifs.gcount() % sizeof(GameplayRecord) != 0)
+		cout << in << " ends with part of a record, which was skipped" << endl;
+	cout << "Converted " << converted << " records to " << out << endl;
+	return 0;
+}
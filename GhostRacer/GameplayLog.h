@@ -0,0 +1,112 @@
+#ifndef GAMEPLAYLOG_H_
+#define GAMEPLAYLOG_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Binary log of what happens in play, for working out afterwards why players die
+// each event is one fixed size record, appended to a lock-free ring owned by the thread that logged it; a background
+// thread drains every ring to the file, so logging costs a tick a few stores and never waits on the disk
+// if a ring fills because the writer fell behind, new records are dropped and counted rather than waited for
+// the file is a GameplayLogHeader followed by the records, and convertGameplayLog() turns it into CSV
+
+enum GameplayEventType {
+	GAMEPLAY_SPAWN,           // value unused
+	GAMEPLAY_DEATH,           // logged once as the actor is removed, value is its DeathCause (Actor.h)
+	GAMEPLAY_DAMAGE,          // value is the damage, negative for healing
+	GAMEPLAY_SCORE,           // value is the points, at the racer
+	GAMEPLAY_SOUL_SAVED,      // value is the souls saved so far this level, at the racer
+	GAMEPLAY_SPRAY_FIRED,     // value is the sprays left, at the spray
+	GAMEPLAY_LEVEL_STARTED,   // value is the level, at the racer
+	GAMEPLAY_LEVEL_FINISHED,  // value is the bonus, at the racer
+	NUM_GAMEPLAY_EVENT_TYPES
+};
+
+// x and y are fixed point, as the actor had them; actorType is its image ID, or -1 if there's no actor
+struct GameplayRecord {
+	uint32_t tick;
+	uint8_t type;
+	int8_t actorType;
+	uint16_t reserved;
+	int32_t x;
+	int32_t y;
+	int32_t value;
+};
+
+struct GameplayLogHeader {
+	char magic[4];            // "GRLG"
+	uint32_t version;
+	uint32_t recordSize;
+	uint32_t reserved;
+};
+
+class GameplayLog {
+public:
+	GameplayLog();
+	~GameplayLog();
+
+	// starts logging to path, returns false if already logging or it can't be opened
+	bool open(std::string path);
+
+	// writes out every record logged so far and closes the file
+	// records logged by other threads while it closes may be lost, so close once play has stopped
+	void close();
+
+	bool isOpen() const {
+		return m_open.load(std::memory_order_relaxed);
+	}
+
+	// appends a record to this thread's ring, does nothing if the log isn't open
+	void record(unsigned int tick, GameplayEventType type, int actorType, int32_t x, int32_t y, int32_t value) {
+		if (isOpen())
+			append(tick, type, actorType, x, y, value);
+	}
+
+	long long getWritten() const;
+	long long getDropped() const;
+
+private:
+	static const unsigned int RING_CAPACITY = 16384;    // records; a power of 2
+	static const int FLUSH_MS = 20;
+
+	// single producer (the thread that owns it), single consumer (the writer)
+	struct Ring {
+		Ring();
+		GameplayRecord records[RING_CAPACITY];
+		std::atomic<unsigned int> head;    // next to write out
+		std::atomic<unsigned int> tail;    // next to fill
+	};
+
+	void append(unsigned int tick, GameplayEventType type, int actorType, int32_t x, int32_t y, int32_t value);
+	Ring* threadRing();
+	void writerLoop();
+	void drain(Ring& ring);
+
+	std::atomic<bool> m_open;
+
+	// rings live as long as the log, so a thread that logs as it's closed never writes into a freed one
+	std::mutex m_mutex;           // guards m_rings and m_stopping
+	std::condition_variable m_wake;
+	std::vector<std::unique_ptr<Ring>> m_rings;
+	bool m_stopping;
+	std::thread m_writer;
+
+	std::ofstream m_file;
+	std::atomic<long long> m_written;
+	std::atomic<long long> m_dropped;
+};
+
+// the log StudentWorld records into
+GameplayLog& gameplayLog();
+
+// writes the binary log at in as CSV to out, returns 0 on success like main()
+int convertGameplayLog(std::string in, std::string out);
+
+#endif // GAMEPLAYLOG_H_
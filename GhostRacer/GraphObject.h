@@ -3,28 +3,97 @@
 
 #include "SpriteManager.h"
 #include "GameConstants.h"
+#include "Fixed.h"
+#include "ActorState.h"
 
-#include <set>
 #include <cmath>
+#include <cstddef>
+#include <cstdlib>
 
-const int ANIMATION_POSITIONS_PER_TICK = 1;
+  // turns bigger than this between two ticks, like a pedestrian turning around, are drawn at once rather than swept through
+const int MAX_INTERPOLATED_TURN = 45;
 
 class GraphObject
 {
   public:
 
+	  // The GraphObjects at one depth, oldest first
+	  // linked through the objects themselves, so adding or removing one never allocates
+	class DepthList
+	{
+	  public:
+		class iterator
+		{
+		  public:
+			explicit iterator(GraphObject* cur) : m_cur(cur) {}
+			GraphObject* operator*() const { return m_cur; }
+			iterator& operator++() { m_cur = m_cur->m_nextInDepth; return *this; }
+			iterator operator++(int) { iterator old = *this; ++*this; return old; }
+			bool operator==(const iterator& other) const { return m_cur == other.m_cur; }
+			bool operator!=(const iterator& other) const { return m_cur != other.m_cur; }
+		  private:
+			GraphObject* m_cur;
+		};
+
+		DepthList() : m_head(nullptr), m_tail(nullptr), m_size(0) {}
+		iterator begin() const { return iterator(m_head); }
+		iterator end() const { return iterator(nullptr); }
+		std::size_t size() const { return m_size; }
+
+		void insert(GraphObject* g)
+		{
+			g->m_prevInDepth = m_tail;
+			g->m_nextInDepth = nullptr;
+			if (m_tail != nullptr)
+				m_tail->m_nextInDepth = g;
+			else
+				m_head = g;
+			m_tail = g;
+			m_size++;
+		}
+
+		void erase(GraphObject* g)
+		{
+			if (g->m_prevInDepth != nullptr)
+				g->m_prevInDepth->m_nextInDepth = g->m_nextInDepth;
+			else
+				m_head = g->m_nextInDepth;
+			if (g->m_nextInDepth != nullptr)
+				g->m_nextInDepth->m_prevInDepth = g->m_prevInDepth;
+			else
+				m_tail = g->m_prevInDepth;
+			m_size--;
+		}
+
+	  private:
+		GraphObject* m_head;
+		GraphObject* m_tail;
+		std::size_t m_size;
+	};
+
 	static const int right = 0;
 	static const int left = 180;
 	static const int up = 90;
 	static const int down = 270;
 
 	GraphObject(int imageID, double startX, double startY, int dir = 0, double size = 1.0, unsigned int depth = 0)
-	 : m_imageID(imageID), m_visible(true), m_x(startX), m_y(startY),
-	   m_destX(startX), m_destY(startY), m_brightness(1.0),
-	   m_animationNumber(0), m_direction(dir), m_size(size), m_depth(depth)
+	 : m_x(toFixed(startX)), m_y(toFixed(startY)), m_prevX(m_x), m_prevY(m_y), m_brightness(FIXED_ONE),
+	   m_animationNumber(0), m_direction(0), m_prevDirection(0), m_animationDirection(0),
+	   m_depth(static_cast<unsigned char>(depth))
 	{
-		if (m_size <= 0)
-			m_size = 1;
+		m_state.x = m_x;
+		m_state.y = m_y;
+		m_state.speedX = 0;
+		m_state.speedY = 0;
+		m_state.size = toFixed(size);
+		m_state.hp = 0;
+		m_state.imageID = static_cast<uint8_t>(imageID);
+		m_state.flags = 0;
+		setDirection(dir);
+		m_prevDirection = m_animationDirection = m_direction;
+
+		if (m_state.size <= 0)
+			m_state.size = FIXED_ONE;
 
 		getGraphObjects(m_depth).insert(this);
 		setVisible(true);
@@ -37,30 +106,48 @@ class GraphObject
 
 	void setVisible(bool shouldIDisplay)
 	{
-		m_visible = shouldIDisplay;
+		if (shouldIDisplay)
+			m_state.flags |= STATE_VISIBLE;
+		else
+			m_state.flags &= ~STATE_VISIBLE;
 	}
 
 	void setBrightness(double brightness)
 	{
-		m_brightness = brightness;
+		m_brightness = toFixed(brightness);
 	}
 
 	double getX() const
 	{
 		  // If already moved but not yet animated, use new location anyway.
-		return m_destX;
+		return fromFixed(m_state.x);
 	}
 
 	double getY() const
 	{
 		  // If already moved but not yet animated, use new location anyway.
-		return m_destY;
+		return fromFixed(m_state.y);
+	}
+
+	fixed getFixedX() const
+	{
+		return m_state.x;
+	}
+
+	fixed getFixedY() const
+	{
+		return m_state.y;
 	}
 
 	virtual void moveTo(double x, double y)
 	{
-		m_destX = x;
-		m_destY = y;
+		moveToFixed(toFixed(x), toFixed(y));
+	}
+
+	void moveToFixed(fixed x, fixed y)
+	{
+		m_state.x = x;
+		m_state.y = y;
 		increaseAnimationNumber();
 	}
 
@@ -75,9 +162,8 @@ class GraphObject
 
 	virtual void getPositionInThisDirection(int angle, int units, double &dx, double &dy)
 	{
-		static const double PI = 4 * atan(1.0);
-		dx = (getX() + units * cos(angle*1.0 / 360 * 2 * PI));
-		dy = (getY() + units * sin(angle*1.0 / 360 * 2 * PI));
+		dx = fromFixed(m_state.x + units * fixedCos(angle));
+		dy = fromFixed(m_state.y + units * fixedSin(angle));
 	}
 
 	void moveForward(int units = 1)
@@ -96,35 +182,40 @@ class GraphObject
 		while (d < 0)
 			d += 360;
 
-		m_direction = d % 360;
+		m_direction = static_cast<short>(d % 360);
 	}
 
 	void setSize(double size)
 	{
-		m_size = size;
+		m_state.size = toFixed(size);
 	}
 
 	double getSize() const
 	{
-		return m_size;
+		return fromFixed(m_state.size);
 	}
 
 	double getRadius() const
+	{
+		return fromFixed(getFixedRadius());
+	}
+
+	fixed getFixedRadius() const
 	{
 		const int kRaidusPerUnit = 8;
-		return kRaidusPerUnit * m_size;
+		return kRaidusPerUnit * m_state.size;
 	}
 
 	  // The following should be used by only the framework, not the student
 
 	bool isVisible() const
 	{
-		return m_visible;
+		return (m_state.flags & STATE_VISIBLE) != 0;
 	}
 
 	double getBrightness() const
 	{
-		return m_brightness;
+		return fromFixed(m_brightness);
 	}
 
 	unsigned int getAnimationNumber() const
@@ -134,21 +225,41 @@ class GraphObject
 
 	void getAnimationLocation(double& x, double& y) const
 	{
-		x = m_x;
-		y = m_y;
+		x = fromFixed(m_x);
+		y = fromFixed(m_y);
 	}
 
-	void animate()
+	int getAnimationDirection() const
 	{
-		m_x = m_destX;
-		m_y = m_destY;
-//		moveALittle(m_x, m_destX);
-	//	moveALittle(m_y, m_destY);
+		return m_animationDirection;
 	}
 
-	static std::set<GraphObject*>& getGraphObjects(unsigned int layer)
+	  // Remember where the object is and which way it faces, as the start of the tick about to be simulated
+	void savePreviousLocation()
 	{
-		static std::set<GraphObject*> graphObjects[NUM_DEPTHS];
+		m_prevX = m_state.x;
+		m_prevY = m_state.y;
+		m_prevDirection = m_direction;
+	}
+
+	  // Place the object alpha of the way (0 to FIXED_ONE) from where it was at the start of the last tick
+	  // to where that tick left it, so frames drawn between ticks show smooth motion
+	void animate(fixed alpha = FIXED_ONE)
+	{
+		m_x = m_prevX + static_cast<fixed>(static_cast<int64_t>(m_state.x - m_prevX) * alpha >> FIXED_SHIFT);
+		m_y = m_prevY + static_cast<fixed>(static_cast<int64_t>(m_state.y - m_prevY) * alpha >> FIXED_SHIFT);
+
+		  // turn the short way round, except through left, which is drawn mirrored rather than rotated
+		int turn = (m_direction - m_prevDirection + 540) % 360 - 180;
+		if (turn == 0  ||  std::abs(turn) > MAX_INTERPOLATED_TURN  ||  m_direction == left  ||  m_prevDirection == left  ||  alpha >= FIXED_ONE)
+			m_animationDirection = m_direction;
+		else
+			m_animationDirection = static_cast<short>((m_prevDirection + 360 + static_cast<int>(static_cast<int64_t>(turn) * alpha >> FIXED_SHIFT)) % 360);
+	}
+
+	static DepthList& getGraphObjects(unsigned int layer)
+	{
+		static DepthList graphObjects[NUM_DEPTHS];
 		if (layer < NUM_DEPTHS)
 			return graphObjects[layer];
 		else
@@ -161,11 +272,16 @@ class GraphObject
 	}
 
 
+  protected:
+	  // hot state first, see ActorState.h; speed, hp and the alive flag belong to Actor
+	ActorState m_state;
+
 private:
 	friend class GameController;
+	friend class SoftwareRenderer;
 	unsigned int getID() const
 	{
-		return m_imageID;
+		return m_state.imageID;
 	}
 
   private:
@@ -174,29 +290,19 @@ private:
 	GraphObject& operator=(const GraphObject&);
 
 	static const int NUM_DEPTHS = 4;
-	int		m_imageID;
-	bool	m_visible;
-	double	m_x;
-	double	m_y;
-	double	m_destX;
-	double	m_destY;
-	double	m_brightness;
+	  // cold render state: where the object was last drawn, and how, and where it was at the start of the tick
+	fixed	m_x;
+	fixed	m_y;
+	fixed	m_prevX;
+	fixed	m_prevY;
+	fixed	m_brightness;
 	int	m_animationNumber;
-	int	m_direction;
-	double	m_size;
-	int		m_depth;
-
-	void moveALittle(double& from, double& to)
-	{
-		static const double DISTANCE = 1.0/ANIMATION_POSITIONS_PER_TICK;
-		if (to - from >= DISTANCE)
-			from += DISTANCE;
-		else if (from - to >= DISTANCE)
-			from -= DISTANCE;
-		else
-			from = to;
-	}
-
+	short	m_direction;
+	short	m_prevDirection;
+	short	m_animationDirection;
+	unsigned char	m_depth;
+	GraphObject*	m_prevInDepth;
+	GraphObject*	m_nextInDepth;
 
 };
 
@@ -0,0 +1,56 @@
+#include "InputQueue.h"
+#include <chrono>
+using namespace std;
+
+// m_head and m_tail count up forever and wrap around unsigned, so tail - head is the size even after they wrap
+
+InputQueue::InputQueue()
+	: m_head(0), m_tail(0), m_dropped(0) {
+}
+
+int64_t InputQueue::now() {
+	return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool InputQueue::push(int key, unsigned int tick) {
+	const unsigned int tail = m_tail.load(memory_order_relaxed);
+	if (tail - m_head.load(memory_order_acquire) == CAPACITY) {
+		m_dropped.fetch_add(1, memory_order_relaxed);
+		return false;
+	}
+	InputEvent& e = m_events[tail % CAPACITY];
+	e.key = key;
+	e.timeNs = now();
+	e.tick = tick;
+	// publishes the event to the consumer
+	m_tail.store(tail + 1, memory_order_release);
+	return true;
+}
+
+bool InputQueue::peek(InputEvent& e) const {
+	const unsigned int head = m_head.load(memory_order_relaxed);
+	if (head == m_tail.load(memory_order_acquire))
+		return false;
+	e = m_events[head % CAPACITY];
+	return true;
+}
+
+bool InputQueue::pop(InputEvent& e) {
+	if (!peek(e))
+		return false;
+	// hands the slot back to the producer
+	m_head.store(m_head.load(memory_order_relaxed) + 1, memory_order_release);
+	return true;
+}
+
+void InputQueue::clear() {
+	m_head.store(m_tail.load(memory_order_acquire), memory_order_release);
+}
+
+unsigned int InputQueue::size() const {
+	return m_tail.load(memory_order_acquire) - m_head.load(memory_order_acquire);
+}
+
+long long InputQueue::getDropped() const {
+	return m_dropped.load(memory_order_relaxed);
+}
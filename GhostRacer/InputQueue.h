@@ -0,0 +1,46 @@
+#ifndef INPUTQUEUE_H_
+#define INPUTQUEUE_H_
+
+#include <atomic>
+#include <cstdint>
+
+// Keys hit between ticks, kept in the order they arrived instead of only the last one
+// a fixed ring, lock free for one thread pushing (the keyboard callbacks) and one popping (the tick),
+// so nothing allocates or waits; when it's full, new keys are counted and dropped rather than overwriting old ones
+
+struct InputEvent {
+	int key;             // KEY_PRESS_* or the character typed
+	int64_t timeNs;      // when it arrived, on the steady clock
+	unsigned int tick;   // the first tick it can apply to, the one that starts after it arrived
+};
+
+class InputQueue {
+public:
+	static const unsigned int CAPACITY = 64;   // a power of two
+
+	InputQueue();
+
+	// producer side: stamps key with the time and tick, returns false if the queue is full
+	bool push(int key, unsigned int tick);
+
+	// consumer side: the oldest event, without or with removing it, returns false if the queue is empty
+	bool peek(InputEvent& e) const;
+	bool pop(InputEvent& e);
+
+	// consumer side: drops every queued event
+	void clear();
+
+	unsigned int size() const;
+	long long getDropped() const;
+
+private:
+	// the steady clock now, in ns
+	static int64_t now();
+
+	InputEvent m_events[CAPACITY];
+	std::atomic<unsigned int> m_head;       // the next event to pop, only written by the consumer
+	std::atomic<unsigned int> m_tail;       // where the next event goes, only written by the producer
+	std::atomic<long long> m_dropped;
+};
+
+#endif // INPUTQUEUE_H_
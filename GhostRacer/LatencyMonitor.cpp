@@ -0,0 +1,91 @@
+#include "LatencyMonitor.h"
+#include <algorithm>
+#include <chrono>
+using namespace std;
+
+LatencyMonitor::LatencyMonitor()
+	: m_numPending(0), m_numRecent(0), m_nextRecent(0), m_newSamples(false) {
+}
+
+int64_t LatencyMonitor::now() {
+	return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+bool LatencyMonitor::openCsv(string path) {
+	m_csv.open(path, ios::out | ios::trunc);
+	if (!m_csv)
+		return false;
+	m_csv << "key,queued_ms,to_frame_ms,to_shown_ms,total_ms\n";
+	return true;
+}
+
+void LatencyMonitor::keyTaken(const InputEvent& e) {
+	// more keys in a tick than the input queue holds can't happen, but if it does the extras go unmeasured
+	if (m_numPending == MAX_PENDING)
+		return;
+	LatencySample& s = m_pending[m_numPending++];
+	s.key = e.key;
+	s.hitNs = e.timeNs;
+	s.takenNs = now();
+	s.drawnNs = 0;
+	s.shownNs = 0;
+}
+
+void LatencyMonitor::frameStarted() {
+	int64_t t = 0;
+	for (int k = 0; k < m_numPending; ++k) {
+		if (m_pending[k].drawnNs == 0)
+			m_pending[k].drawnNs = (t != 0 ? t : (t = now()));
+	}
+}
+
+void LatencyMonitor::frameShown() {
+	if (m_numPending == 0)
+		return;
+	const int64_t t = now();
+	int kept = 0;
+	for (int k = 0; k < m_numPending; ++k) {
+		LatencySample& s = m_pending[k];
+		if (s.drawnNs == 0) {
+			// taken after this frame started, so it's shown in a later one
+			m_pending[kept++] = s;
+			continue;
+		}
+		s.shownNs = t;
+		record(s);
+	}
+	m_numPending = kept;
+}
+
+void LatencyMonitor::record(const LatencySample& s) {
+	const double total = (s.shownNs - s.hitNs) / 1e6;
+	m_recent[m_nextRecent] = total;
+	m_nextRecent = (m_nextRecent + 1) % RECENT;
+	if (m_numRecent < RECENT)
+		++m_numRecent;
+	m_newSamples = true;
+
+	if (m_csv.is_open()) {
+		m_csv << s.key << ',' << (s.takenNs - s.hitNs) / 1e6 << ',' << (s.drawnNs - s.takenNs) / 1e6 << ','
+			  << (s.shownNs - s.drawnNs) / 1e6 << ',' << total << '\n';
+	}
+}
+
+bool LatencyMonitor::hasNewSamples() const {
+	return m_newSamples;
+}
+
+LatencySummary LatencyMonitor::getSummary() {
+	m_newSamples = false;
+	LatencySummary summary = { m_numRecent, 0, 0, 0 };
+	if (m_numRecent == 0)
+		return summary;
+
+	double sorted[RECENT];
+	copy(m_recent, m_recent + m_numRecent, sorted);
+	sort(sorted, sorted + m_numRecent);
+	summary.p50 = sorted[(m_numRecent - 1) / 2];
+	summary.p95 = sorted[(m_numRecent - 1) * 95 / 100];
+	summary.max = sorted[m_numRecent - 1];
+	return summary;
+}
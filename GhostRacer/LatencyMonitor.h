@@ -0,0 +1,64 @@
+#ifndef LATENCYMONITOR_H_
+#define LATENCYMONITOR_H_
+
+#include "InputQueue.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+// Input to photon latency, measured for every key a tick takes
+// a key is stamped when it's hit (InputEvent::timeNs), when the tick's move() takes it, when the first frame
+// showing all of that tick's motion starts drawing (frames interpolated part way from the tick before don't count),
+// and when that frame's glutSwapBuffers() returns, which is as close to the photons as the game can see
+// the totals of recent keys are summarised for an overlay, and every key can go to a CSV
+
+struct LatencySample {
+	int key;
+	int64_t hitNs;        // all on the steady clock
+	int64_t takenNs;
+	int64_t drawnNs;      // 0 until the frame starts
+	int64_t shownNs;
+};
+
+// percentiles of the recent totals, hit to shown, in ms
+struct LatencySummary {
+	int samples;
+	double p50;
+	double p95;
+	double max;
+};
+
+class LatencyMonitor {
+public:
+	LatencyMonitor();
+
+	// writes each key's stamps to path as it's shown, returns false if it can't
+	bool openCsv(std::string path);
+
+	// the stages, called in this order for each key; none of them allocate
+	void keyTaken(const InputEvent& e);
+	void frameStarted();
+	void frameShown();
+
+	// whether a key has been shown since the last getSummary()
+	bool hasNewSamples() const;
+	LatencySummary getSummary();
+
+	static int64_t now();
+
+private:
+	void record(const LatencySample& s);
+
+	static const int MAX_PENDING = 64;    // keys taken but not yet shown; as many as InputQueue holds
+	static const int RECENT = 256;        // how many keys the summary covers
+
+	LatencySample m_pending[MAX_PENDING];
+	int m_numPending;
+	double m_recent[RECENT];              // totals in ms, as a ring
+	int m_numRecent;
+	int m_nextRecent;
+	bool m_newSamples;
+	std::ofstream m_csv;
+};
+
+#endif // LATENCYMONITOR_H_
@@ -0,0 +1,61 @@
+#include "LevelData.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+using namespace std;
+
+LevelDef defaultLevel(int level) {
+	LevelDef def;
+	def.spawnChance[SPAWN_HUMAN] = max(200 - level * 10, 30);
+	def.spawnChance[SPAWN_ZOMBIE] = max(100 - level * 10, 30);
+	def.spawnChance[SPAWN_CAB] = max(100 - level * 10, 20);
+	def.spawnChance[SPAWN_OIL] = max(150 - level * 10, 40);
+	def.spawnChance[SPAWN_HOLY_WATER] = 100 + 10 * level;
+	def.spawnChance[SPAWN_SOUL] = 100;
+	def.cabMinSpeed = 2;
+	def.cabMaxSpeed = 4;
+	def.soulsToSave = level * 2 + 5;
+	def.bonus = 5000;
+	def.oilDropChance = 5;
+	def.healDropChance = 5;
+	return def;
+}
+
+bool loadLevels(string file, vector<LevelDef>& levels) {
+	ifstream in(file);
+	if (!in)
+		return true;	// no file, use the defaults
+
+	string line;
+	while (getline(in, line)) {
+		size_t start = line.find_first_not_of(" \t\r");
+		if (start == string::npos || line[start] == '#')
+			continue;	// blank line or comment
+
+		istringstream fields(line);
+		int level;
+		LevelDef def;
+		fields >> level;
+		for (int k = 0; k < NUM_SPAWN_TYPES; ++k)
+			fields >> def.spawnChance[k];
+		fields >> def.cabMinSpeed >> def.cabMaxSpeed >> def.soulsToSave >> def.bonus
+			>> def.oilDropChance >> def.healDropChance;
+
+		string extra;
+		if (!fields || fields >> extra)
+			return false;	// too few or too many fields
+		if (level != static_cast<int>(levels.size()) + 1)
+			return false;	// levels must be in order with none missing
+
+		for (int k = 0; k < NUM_SPAWN_TYPES; ++k) {
+			if (def.spawnChance[k] < 1)
+				return false;
+		}
+		if (def.cabMinSpeed < 0 || def.cabMaxSpeed < def.cabMinSpeed || def.soulsToSave < 1 || def.bonus < 0
+			|| def.oilDropChance < 1 || def.healDropChance < 1)
+			return false;
+
+		levels.push_back(def);
+	}
+	return true;
+}
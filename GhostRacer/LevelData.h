@@ -0,0 +1,33 @@
+#ifndef LEVELDATA_H_
+#define LEVELDATA_H_
+
+#include <string>
+#include <vector>
+
+// Level definitions, loaded from levels.txt in the asset directory
+// each non-comment line defines one level, in order starting from level 1:
+//   level humans zombies cabs oil holywater souls cabMinSpeed cabMaxSpeed soulsToSave bonus oilDrop healDrop
+// spawn and drop columns are "1 in N" chances, cab speeds are relative to the racer's,
+// and lines starting with # are comments
+// levels past the last one defined, or every level if there's no file, use defaultLevel()
+
+enum SpawnType { SPAWN_HUMAN, SPAWN_ZOMBIE, SPAWN_CAB, SPAWN_OIL, SPAWN_HOLY_WATER, SPAWN_SOUL, NUM_SPAWN_TYPES };
+
+struct LevelDef {
+	int spawnChance[NUM_SPAWN_TYPES];	// each type spawns with a 1 in spawnChance chance per tick
+	int cabMinSpeed;
+	int cabMaxSpeed;
+	int soulsToSave;
+	int bonus;							// starting bonus, counts down by 1 per tick
+	int oilDropChance;					// 1 in oilDropChance for a sprayed cab to drop an Oil Slick
+	int healDropChance;					// 1 in healDropChance for a sprayed zombie to drop a Healing Goodie
+};
+
+// the original hard-coded rules for the given level
+LevelDef defaultLevel(int level);
+
+// appends the levels in file to levels
+// returns false if the file exists but is malformed, true if it loaded or doesn't exist
+bool loadLevels(std::string file, std::vector<LevelDef>& levels);
+
+#endif // LEVELDATA_H_
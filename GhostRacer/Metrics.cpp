@@ -0,0 +1,318 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#ifdef _MSC_VER
+#include <winsock2.h>
+#pragma comment(lib, "ws2_32.lib")
+typedef SOCKET SocketHandle;
+#else
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int SocketHandle;
+#define closesocket close
+#endif
+using namespace std;
+
+static const char* const ACTOR_TYPE_NAMES[NUM_METRIC_ACTOR_TYPES] = {
+	"ghost_racer", "yellow_border_line", "white_border_line", "oil_slick", "human", "zombie", "zombie_cab",
+	"spray", "heal_goodie", "soul_goodie", "holy_water_goodie"
+};
+
+// how long the socket exporter waits for a connection at a time, so stop() never waits longer
+static const int SOCKET_POLL_MS = 100;
+
+Metrics::Metrics()
+	: m_timingTicks(false), m_ticks(0), m_tickNs(0), m_soundsPlayed(0), m_soundsDropped(0), m_frames(0) {
+	for (int t = 0; t < NUM_METRIC_ACTOR_TYPES; ++t) {
+		m_spawns[t] = 0;
+		m_deaths[t] = 0;
+		m_live[t] = 0;
+	}
+	for (int b = 0; b < NUM_TICK_BUCKETS; ++b)
+		m_tickBuckets[b] = 0;
+}
+
+void Metrics::setTimingTicks(bool on) {
+	m_timingTicks.store(on, memory_order_relaxed);
+}
+
+void Metrics::actorSpawned(int imageID) {
+	if (validType(imageID))
+		m_spawns[imageID].fetch_add(1, memory_order_relaxed);
+}
+
+void Metrics::actorDied(int imageID) {
+	if (validType(imageID))
+		m_deaths[imageID].fetch_add(1, memory_order_relaxed);
+}
+
+void Metrics::setLiveActors(int imageID, int count) {
+	if (validType(imageID))
+		m_live[imageID].store(count, memory_order_relaxed);
+}
+
+void Metrics::tickDone(long long ns) {
+	m_ticks.fetch_add(1, memory_order_relaxed);
+	int b = 0;
+	while (b < NUM_TICK_BUCKETS - 1 && ns > TICK_BUCKET_US[b] * 1000)
+		++b;
+	m_tickBuckets[b].fetch_add(1, memory_order_relaxed);
+	m_tickNs.fetch_add(ns, memory_order_relaxed);
+}
+
+void Metrics::soundPlayed() {
+	m_soundsPlayed.fetch_add(1, memory_order_relaxed);
+}
+
+void Metrics::soundDropped() {
+	m_soundsDropped.fetch_add(1, memory_order_relaxed);
+}
+
+void Metrics::frameDrawn() {
+	m_frames.fetch_add(1, memory_order_relaxed);
+}
+
+MetricsSnapshot Metrics::snapshot() const {
+	MetricsSnapshot s;
+	for (int t = 0; t < NUM_METRIC_ACTOR_TYPES; ++t) {
+		s.spawns[t] = m_spawns[t].load(memory_order_relaxed);
+		s.deaths[t] = m_deaths[t].load(memory_order_relaxed);
+		s.live[t] = m_live[t].load(memory_order_relaxed);
+	}
+	s.ticks = m_ticks.load(memory_order_relaxed);
+	for (int b = 0; b < NUM_TICK_BUCKETS; ++b)
+		s.tickBuckets[b] = m_tickBuckets[b].load(memory_order_relaxed);
+	s.tickNs = m_tickNs.load(memory_order_relaxed);
+	s.soundsPlayed = m_soundsPlayed.load(memory_order_relaxed);
+	s.soundsDropped = m_soundsDropped.load(memory_order_relaxed);
+	s.frames = m_frames.load(memory_order_relaxed);
+	return s;
+}
+
+// the 99th percentile of the ticks timed between prev and now, in seconds, interpolated within its bucket
+// ticks slower than the last bound count as the last bound
+static double tickP99(const MetricsSnapshot& now, const MetricsSnapshot& prev) {
+	long long total = 0;
+	for (int b = 0; b < NUM_TICK_BUCKETS; ++b)
+		total += now.tickBuckets[b] - prev.tickBuckets[b];
+	if (total == 0)
+		return 0;
+
+	const double target = total * 0.99;
+	long long before = 0;
+	for (int b = 0; b < NUM_TICK_BUCKETS - 1; ++b) {
+		const long long count = now.tickBuckets[b] - prev.tickBuckets[b];
+		if (before + count >= target) {
+			const double lower = (b == 0 ? 0 : TICK_BUCKET_US[b - 1]);
+			return (lower + (TICK_BUCKET_US[b] - lower) * (target - before) / count) / 1e6;
+		}
+		before += count;
+	}
+	return TICK_BUCKET_US[NUM_TICK_BUCKETS - 2] / 1e6;
+}
+
+// one metric's HELP and TYPE lines
+static void describe(ostringstream& oss, const char* name, const char* type, const char* help) {
+	oss << "# HELP " << name << ' ' << help << "\n# TYPE " << name << ' ' << type << '\n';
+}
+
+// one value per actor type
+static void perType(ostringstream& oss, const char* name, const long long* values) {
+	for (int t = 0; t < NUM_METRIC_ACTOR_TYPES; ++t)
+		oss << name << "{type=\"" << ACTOR_TYPE_NAMES[t] << "\"} " << values[t] << '\n';
+}
+
+string Metrics::format(const MetricsSnapshot& now, const MetricsSnapshot& prev, double seconds) {
+	ostringstream oss;
+	describe(oss, "ghostracer_actors_live", "gauge", "Actors in play at the end of the last tick.");
+	perType(oss, "ghostracer_actors_live", now.live);
+	describe(oss, "ghostracer_actor_spawns_total", "counter", "Actors added to play.");
+	perType(oss, "ghostracer_actor_spawns_total", now.spawns);
+	describe(oss, "ghostracer_actor_deaths_total", "counter", "Actors that died, whether by damage, being hit, leaving the screen or being used up.");
+	perType(oss, "ghostracer_actor_deaths_total", now.deaths);
+
+	describe(oss, "ghostracer_ticks_total", "counter", "Ticks simulated while timed.");
+	oss << "ghostracer_ticks_total " << now.ticks << '\n';
+	describe(oss, "ghostracer_ticks_per_second", "gauge", "Ticks simulated per second over the last export period.");
+	oss << "ghostracer_ticks_per_second " << (seconds > 0 ? (now.ticks - prev.ticks) / seconds : 0) << '\n';
+	describe(oss, "ghostracer_tick_seconds", "histogram", "Time StudentWorld::move() took.");
+	long long cumulative = 0;
+	for (int b = 0; b < NUM_TICK_BUCKETS; ++b) {
+		cumulative += now.tickBuckets[b];
+		oss << "ghostracer_tick_seconds_bucket{le=\"";
+		if (b < NUM_TICK_BUCKETS - 1)
+			oss << TICK_BUCKET_US[b] / 1e6;
+		else
+			oss << "+Inf";
+		oss << "\"} " << cumulative << '\n';
+	}
+	oss << "ghostracer_tick_seconds_sum " << now.tickNs / 1e9 << '\n';
+	oss << "ghostracer_tick_seconds_count " << cumulative << '\n';
+	describe(oss, "ghostracer_tick_p99_seconds", "gauge", "99th percentile tick time over the last export period.");
+	oss << "ghostracer_tick_p99_seconds " << tickP99(now, prev) << '\n';
+
+	describe(oss, "ghostracer_sounds_played_total", "counter", "Sounds started.");
+	oss << "ghostracer_sounds_played_total " << now.soundsPlayed << '\n';
+	describe(oss, "ghostracer_sounds_dropped_total", "counter", "Sounds not started, as duplicates in a turbo batch or unknown.");
+	oss << "ghostracer_sounds_dropped_total " << now.soundsDropped << '\n';
+	describe(oss, "ghostracer_frames_drawn_total", "counter", "Frames drawn.");
+	oss << "ghostracer_frames_drawn_total " << now.frames << '\n';
+	return oss.str();
+}
+
+Metrics& metrics() {
+	static Metrics m;
+	return m;
+}
+
+MetricsExporter::MetricsExporter()
+	: m_socket(-1), m_periodMs(1000), m_stopping(false) {
+	// so metrics() outlives the exporter, whose thread may still be reading it as the program exits
+	metrics();
+}
+
+MetricsExporter::~MetricsExporter() {
+	stop();
+}
+
+bool MetricsExporter::start(string target, int periodMs) {
+	if (m_thread.joinable())
+		return false;
+	m_periodMs = max(periodMs, 1);
+	m_socket = -1;
+	m_path.clear();
+
+	if (!target.empty() && target[0] == ':') {
+#ifdef _MSC_VER
+		WSADATA wsa;
+		if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+			return false;
+#endif
+		SocketHandle s = socket(AF_INET, SOCK_STREAM, 0);
+		if (s == static_cast<SocketHandle>(-1))
+			return false;
+		int reuse = 1;
+		setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&reuse), sizeof(reuse));
+		sockaddr_in addr = sockaddr_in();
+		addr.sin_family = AF_INET;
+		addr.sin_port = htons(static_cast<unsigned short>(atoi(target.c_str() + 1)));
+		addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+		if (bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(s, 4) != 0) {
+			closesocket(s);
+			return false;
+		}
+		m_socket = static_cast<long long>(s);
+	}
+	else {
+		m_path = target;
+		if (!writeFile(Metrics::format(metrics().snapshot(), metrics().snapshot(), 0)))
+			return false;
+	}
+
+	m_stopping = false;
+	metrics().setTimingTicks(true);
+	m_thread = thread(&MetricsExporter::run, this);
+	return true;
+}
+
+void MetricsExporter::stop() {
+	if (!m_thread.joinable())
+		return;
+	{
+		lock_guard<mutex> lock(m_mutex);
+		m_stopping = true;
+	}
+	m_wake.notify_one();
+	m_thread.join();
+	metrics().setTimingTicks(false);
+	if (m_socket != -1) {
+		closesocket(static_cast<SocketHandle>(m_socket));
+		m_socket = -1;
+	}
+}
+
+void MetricsExporter::run() {
+	MetricsSnapshot prev = metrics().snapshot();
+	chrono::steady_clock::time_point prevTime = chrono::steady_clock::now();
+	string text = Metrics::format(prev, prev, 0);
+
+	unique_lock<mutex> lock(m_mutex);
+	while (!m_stopping) {
+		chrono::steady_clock::time_point due = prevTime + chrono::milliseconds(m_periodMs);
+		if (m_socket == -1) {
+			m_wake.wait_until(lock, due);
+		}
+		else {
+			// serve anyone who connects while waiting for the next period, whatever they ask for
+			lock.unlock();
+			SocketHandle s = static_cast<SocketHandle>(m_socket);
+			fd_set ready;
+			FD_ZERO(&ready);
+			FD_SET(s, &ready);
+			timeval timeout = { 0, SOCKET_POLL_MS * 1000 };
+			if (select(static_cast<int>(s) + 1, &ready, nullptr, nullptr, &timeout) > 0) {
+				SocketHandle client = accept(s, nullptr, nullptr);
+				if (client != static_cast<SocketHandle>(-1)) {
+					// read the request if it's already here, but don't wait long for it
+					FD_ZERO(&ready);
+					FD_SET(client, &ready);
+					timeval requestTimeout = { 0, SOCKET_POLL_MS * 1000 };
+					char request[1024];
+					if (select(static_cast<int>(client) + 1, &ready, nullptr, nullptr, &requestTimeout) > 0)
+						recv(client, request, sizeof(request), 0);
+					ostringstream response;
+					response << "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+						<< text.size() << "\r\nConnection: close\r\n\r\n" << text;
+					const string r = response.str();
+					send(client, r.data(), static_cast<int>(r.size()), 0);
+					closesocket(client);
+				}
+			}
+			lock.lock();
+		}
+		if (m_stopping || chrono::steady_clock::now() < due)
+			continue;
+		exportSnapshot(prev, prevTime, text);
+	}
+
+	// once more as it stops, so a run that ends part way through a period leaves its final totals in the file
+	if (m_socket == -1)
+		exportSnapshot(prev, prevTime, text);
+}
+
+void MetricsExporter::exportSnapshot(MetricsSnapshot& prev, chrono::steady_clock::time_point& prevTime, string& text) {
+	chrono::steady_clock::time_point now = chrono::steady_clock::now();
+	MetricsSnapshot snapshot = metrics().snapshot();
+	text = Metrics::format(snapshot, prev, chrono::duration<double>(now - prevTime).count());
+	prev = snapshot;
+	prevTime = now;
+	if (m_socket == -1 && !writeFile(text))
+		cout << "Cannot write metrics to " << m_path << endl;
+}
+
+bool MetricsExporter::writeFile(const string& text) {
+	// written to the side and renamed, so a scraper never reads half a file
+	const string temp = m_path + ".tmp";
+	{
+		ofstream ofs(temp, ios::out | ios::trunc);
+		if (!ofs || !(ofs << text))
+			return false;
+	}
+#ifdef _MSC_VER
+	// rename() won't replace a file on Windows
+	remove(m_path.c_str());
+#endif
+	return rename(temp.c_str(), m_path.c_str()) == 0;
+}
+
+MetricsExporter& metricsExporter() {
+	static MetricsExporter exporter;
+	return exporter;
+}
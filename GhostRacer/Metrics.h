@@ -0,0 +1,131 @@
+#ifndef METRICS_H_
+#define METRICS_H_
+
+#include "GameConstants.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Live counters and gauges for soak tests, exported in the Prometheus text format
+// the game updates them with relaxed atomic adds and stores, so updating never locks or allocates; a MetricsExporter's
+// thread reads them every period and writes the text to a file or serves it from a localhost socket
+// spawns and deaths are totals, as Prometheus counters are, so a dashboard's rate() gives them per second; ticks/s and
+// the tick time p99 are worked out by the exporter over each period
+
+// one slot per image ID that's an actor
+const int NUM_METRIC_ACTOR_TYPES = IID_ROAD;
+
+// upper bounds of the tick time histogram's buckets in microseconds, then one for anything slower
+const int NUM_TICK_BUCKETS = 12;
+const double TICK_BUCKET_US[NUM_TICK_BUCKETS - 1] = { 50, 100, 200, 500, 1000, 2000, 5000, 10000, 20000, 50000, 100000 };
+
+// the counters at one moment, as the exporter reads them
+struct MetricsSnapshot {
+	long long spawns[NUM_METRIC_ACTOR_TYPES];
+	long long deaths[NUM_METRIC_ACTOR_TYPES];
+	long long live[NUM_METRIC_ACTOR_TYPES];
+	long long ticks;
+	long long tickBuckets[NUM_TICK_BUCKETS];
+	long long tickNs;
+	long long soundsPlayed;
+	long long soundsDropped;
+	long long frames;
+};
+
+class Metrics {
+public:
+	Metrics();
+
+	// tick times are only measured while something exports them, as reading the clock isn't free
+	bool isTimingTicks() const {
+		return m_timingTicks.load(std::memory_order_relaxed);
+	}
+	void setTimingTicks(bool on);
+
+	void actorSpawned(int imageID);
+	void actorDied(int imageID);
+	void setLiveActors(int imageID, int count);
+	void tickDone(long long ns);
+	void soundPlayed();
+	void soundDropped();      // coalesced with the same sound in a turbo batch, or not a known sound
+	void frameDrawn();
+
+	MetricsSnapshot snapshot() const;
+
+	// the metrics as Prometheus text, with ticks/s and the tick time p99 over the seconds since prev
+	static std::string format(const MetricsSnapshot& now, const MetricsSnapshot& prev, double seconds);
+
+private:
+	static bool validType(int imageID) {
+		return imageID >= 0 && imageID < NUM_METRIC_ACTOR_TYPES;
+	}
+
+	std::atomic<bool> m_timingTicks;
+	std::atomic<long long> m_spawns[NUM_METRIC_ACTOR_TYPES];
+	std::atomic<long long> m_deaths[NUM_METRIC_ACTOR_TYPES];
+	std::atomic<long long> m_live[NUM_METRIC_ACTOR_TYPES];
+	std::atomic<long long> m_ticks;
+	std::atomic<long long> m_tickBuckets[NUM_TICK_BUCKETS];
+	std::atomic<long long> m_tickNs;
+	std::atomic<long long> m_soundsPlayed;
+	std::atomic<long long> m_soundsDropped;
+	std::atomic<long long> m_frames;
+};
+
+// the metrics the game updates
+Metrics& metrics();
+
+// adds the time from construction to destruction to the tick time histogram, if ticks are being timed
+class TickMetric {
+public:
+	TickMetric()
+		: m_timing(metrics().isTimingTicks()) {
+		if (m_timing)
+			m_start = std::chrono::steady_clock::now();
+	}
+
+	~TickMetric() {
+		if (m_timing)
+			metrics().tickDone(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_start).count());
+	}
+
+private:
+	bool m_timing;
+	std::chrono::steady_clock::time_point m_start;
+};
+
+class MetricsExporter {
+public:
+	MetricsExporter();
+	~MetricsExporter();
+
+	// exports metrics() every periodMs until stop()
+	// target ":9100" serves http://127.0.0.1:9100/metrics, anything else is a file rewritten each period
+	// returns false if already exporting or the file or socket can't be opened
+	bool start(std::string target, int periodMs = 1000);
+	void stop();
+
+private:
+	void run();
+	// formats metrics() against prev, taken at prevTime, into text, writes it out if exporting to a file,
+	// and makes it the new prev
+	void exportSnapshot(MetricsSnapshot& prev, std::chrono::steady_clock::time_point& prevTime, std::string& text);
+	bool writeFile(const std::string& text);
+
+	std::string m_path;
+	long long m_socket;       // listening, or -1 when exporting to a file
+	int m_periodMs;
+
+	std::mutex m_mutex;       // guards m_stopping
+	std::condition_variable m_wake;
+	bool m_stopping;
+	std::thread m_thread;
+};
+
+// the exporter main() starts for "-metrics"
+MetricsExporter& metricsExporter();
+
+#endif // METRICS_H_
@@ -0,0 +1,232 @@
+#include "MotionKernel.h"
+#include "Actor.h"
+#include "GameConstants.h"
+#include <algorithm>
+#include <cstdlib>
+
+// the AVX2 pass is compiled into every x86 build and chosen at run time, so builds that don't enable AVX2 for
+// everything (the default for both MSVC and g++) still use it where the CPU has it
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MOTION_HAS_AVX2
+#define MOTION_TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#define MOTION_HAS_AVX2
+#define MOTION_TARGET_AVX2
+#endif
+
+enum MotionFlags {
+	MOTION_OFF_SCREEN = 1,          // killed when it left, so it's only killed once
+	MOTION_TOUCHING_RACER = 2
+};
+
+// what a pass reads and writes
+struct MotionPass {
+	Actor* const* actors;
+	fixed* x;
+	fixed* y;
+	const fixed* speedX;
+	const fixed* speedY;
+	const fixed* radius;
+	int* flags;
+	int n;
+	fixed scrollY;
+	fixed racerX;
+	fixed racerY;
+	fixed racerRadius;
+};
+
+// distances past which nothing overlaps, so larger ones can be clamped without changing the test or overflowing it
+const fixed MOTION_FAR = 2 * VIEW_HEIGHT * FIXED_ONE;
+
+// slots [k, p.n) one at a time; returns whether any overlap the racer
+static bool moveScalar(const MotionPass& p, int k) {
+	const fixed width = VIEW_WIDTH * FIXED_ONE;
+	const fixed height = VIEW_HEIGHT * FIXED_ONE;
+	const int n = p.n;
+	bool touching = false;
+	for (; k < n; ++k) {
+		fixed x = p.x[k] += p.speedX[k];
+		fixed y = p.y[k] = p.y[k] + p.speedY[k] - p.scrollY;
+		bool off = x < 0 || y < 0 || x > width || y > height;
+		if (off && !(p.flags[k] & MOTION_OFF_SCREEN))
+			p.actors[k]->kill(DEATH_OFF_SCREEN);
+
+		// same test as overlap()
+		int64_t delX = std::abs(static_cast<int64_t>(x) - p.racerX);
+		int64_t delY = std::abs(static_cast<int64_t>(y) - p.racerY);
+		int64_t radSum = static_cast<int64_t>(p.radius[k]) + p.racerRadius;
+		bool touch = delX * 4 < radSum && delY * 10 < radSum * 6;
+		touching = touching || touch;
+		p.flags[k] = ((off || (p.flags[k] & MOTION_OFF_SCREEN)) ? MOTION_OFF_SCREEN : 0) | (touch ? MOTION_TOUCHING_RACER : 0);
+	}
+	return touching;
+}
+
+#ifdef MOTION_HAS_AVX2
+// as moveScalar(), 8 slots at a time, with the remainder left to it
+MOTION_TARGET_AVX2
+static bool moveAvx2(const MotionPass& p) {
+	const __m256i scroll = _mm256_set1_epi32(p.scrollY);
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i right = _mm256_set1_epi32(VIEW_WIDTH * FIXED_ONE);
+	const __m256i top = _mm256_set1_epi32(VIEW_HEIGHT * FIXED_ONE);
+	const __m256i racerX = _mm256_set1_epi32(p.racerX);
+	const __m256i racerY = _mm256_set1_epi32(p.racerY);
+	const __m256i racerRadius = _mm256_set1_epi32(p.racerRadius);
+	const __m256i far = _mm256_set1_epi32(MOTION_FAR);
+	const __m256i offBit = _mm256_set1_epi32(MOTION_OFF_SCREEN);
+	const __m256i touchBit = _mm256_set1_epi32(MOTION_TOUCHING_RACER);
+	// in locals, as the stores below could otherwise alias p's members and force them to be reloaded every time
+	fixed* const xs = p.x;
+	fixed* const ys = p.y;
+	const fixed* const speedXs = p.speedX;
+	const fixed* const speedYs = p.speedY;
+	const fixed* const radii = p.radius;
+	int* const allFlags = p.flags;
+	const int n = p.n;
+	int touching = 0;
+	int k = 0;
+	for (; k + 8 <= n; k += 8) {
+		__m256i x = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(xs + k)),
+			_mm256_loadu_si256(reinterpret_cast<const __m256i*>(speedXs + k)));
+		__m256i y = _mm256_sub_epi32(_mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ys + k)),
+			_mm256_loadu_si256(reinterpret_cast<const __m256i*>(speedYs + k))), scroll);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(xs + k), x);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(ys + k), y);
+
+		// same test as Actor::checkInBounds(), and only actors that weren't already off screen are killed
+		__m256i off = _mm256_or_si256(
+			_mm256_or_si256(_mm256_cmpgt_epi32(zero, x), _mm256_cmpgt_epi32(zero, y)),
+			_mm256_or_si256(_mm256_cmpgt_epi32(x, right), _mm256_cmpgt_epi32(y, top)));
+		__m256i flags = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(allFlags + k));
+		__m256i wasOff = _mm256_cmpeq_epi32(_mm256_and_si256(flags, offBit), offBit);
+		int left = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_andnot_si256(wasOff, off)));
+		for (int j = 0; left != 0; ++j, left >>= 1) {
+			if (left & 1)
+				p.actors[k + j]->kill(DEATH_OFF_SCREEN);
+		}
+
+		// same test as overlap(): delX * 4 < radSum and delY * 10 < radSum * 6, as delY * 5 < radSum * 3
+		__m256i delX = _mm256_min_epu32(_mm256_abs_epi32(_mm256_sub_epi32(x, racerX)), far);
+		__m256i delY = _mm256_min_epu32(_mm256_abs_epi32(_mm256_sub_epi32(y, racerY)), far);
+		__m256i radSum = _mm256_add_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(radii + k)), racerRadius);
+		__m256i touch = _mm256_and_si256(
+			_mm256_cmpgt_epi32(radSum, _mm256_slli_epi32(delX, 2)),
+			_mm256_cmpgt_epi32(_mm256_add_epi32(_mm256_slli_epi32(radSum, 1), radSum),
+				_mm256_add_epi32(_mm256_slli_epi32(delY, 2), delY)));
+		touching |= _mm256_movemask_ps(_mm256_castsi256_ps(touch));
+
+		flags = _mm256_or_si256(_mm256_and_si256(_mm256_or_si256(off, wasOff), offBit), _mm256_and_si256(touch, touchBit));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(allFlags + k), flags);
+	}
+	return moveScalar(p, k) || touching != 0;
+}
+
+// whether this CPU, and the OS, can run AVX2
+static bool cpuHasAvx2() {
+#if defined(__GNUC__)
+	return __builtin_cpu_supports("avx2");
+#else
+	int info[4];
+	__cpuid(info, 1);
+	bool ymmSaved = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6) == 6;
+	__cpuidex(info, 7, 0);
+	return ymmSaved && (info[1] & (1 << 5)) != 0;
+#endif
+}
+#endif
+
+MotionKernel::MotionKernel()
+	: m_moved(false) {}
+
+void MotionKernel::add(Actor* a) {
+	a->setMotionSlot(static_cast<int>(m_actors.size()));
+	m_actors.push_back(a);
+	m_x.push_back(a->getFixedX());
+	m_y.push_back(a->getFixedY());
+	m_speedX.push_back(a->getFixedSpeedX());
+	m_speedY.push_back(a->getFixedSpeedY());
+	m_radius.push_back(a->getFixedRadius());
+	m_flags.push_back(0);
+}
+
+void MotionKernel::remove(int slot) {
+	int last = size() - 1;
+	if (slot != last) {
+		m_actors[slot] = m_actors[last];
+		m_x[slot] = m_x[last];
+		m_y[slot] = m_y[last];
+		m_speedX[slot] = m_speedX[last];
+		m_speedY[slot] = m_speedY[last];
+		m_radius[slot] = m_radius[last];
+		m_flags[slot] = m_flags[last];
+		m_actors[slot]->setMotionSlot(slot);
+	}
+	m_actors.pop_back();
+	m_x.pop_back();
+	m_y.pop_back();
+	m_speedX.pop_back();
+	m_speedY.pop_back();
+	m_radius.pop_back();
+	m_flags.pop_back();
+}
+
+void MotionKernel::clear() {
+	m_actors.clear();
+	m_x.clear();
+	m_y.clear();
+	m_speedX.clear();
+	m_speedY.clear();
+	m_radius.clear();
+	m_flags.clear();
+	m_moved = false;
+}
+
+void MotionKernel::reserve(int n) {
+	m_actors.reserve(n);
+	m_x.reserve(n);
+	m_y.reserve(n);
+	m_speedX.reserve(n);
+	m_speedY.reserve(n);
+	m_radius.reserve(n);
+	m_flags.reserve(n);
+}
+
+int MotionKernel::size() const {
+	return static_cast<int>(m_actors.size());
+}
+
+bool MotionKernel::update(fixed scrollY, const Actor* racer) {
+	MotionPass p = { m_actors.data(), m_x.data(), m_y.data(), m_speedX.data(), m_speedY.data(), m_radius.data(),
+		m_flags.data(), size(), scrollY, racer->getFixedX(), racer->getFixedY(), racer->getFixedRadius() };
+	m_moved = true;
+#ifdef MOTION_HAS_AVX2
+	static const bool avx2 = cpuHasAvx2();
+	if (avx2)
+		return moveAvx2(p);
+#endif
+	return moveScalar(p, 0);
+}
+
+fixed MotionKernel::getX(int slot) const {
+	return m_x[slot];
+}
+
+fixed MotionKernel::getY(int slot) const {
+	return m_y[slot];
+}
+
+bool MotionKernel::isTouchingRacer(int slot) const {
+	return (m_flags[slot] & MOTION_TOUCHING_RACER) != 0;
+}
+
+void MotionKernel::syncDrawnPositions() {
+	if (!m_moved)
+		return;
+	for (int k = 0; k < size(); ++k)
+		m_actors[k]->GraphObject::moveToFixed(m_x[k], m_y[k]);
+	m_moved = false;
+}
@@ -0,0 +1,58 @@
+#ifndef MOTIONKERNEL_H_
+#define MOTIONKERNEL_H_
+
+#include "Fixed.h"
+#include <vector>
+
+class Actor;
+
+// Movement for actors that only scroll with the road (Goodies)
+// fixed point positions, speeds and radii are held in parallel arrays and advanced in one vectorized pass per tick
+// (AVX2 where the CPU has it, 8 actors at a time, scalar otherwise), instead of each actor moving itself in doSomething()
+// the arrays are the actors' positions: the same pass kills actors that leave the screen and marks those touching the
+// racer, so the rest of a tick only touches the few actors that did either, and positions are only written to
+// GraphObjects by syncDrawnPositions(), when a frame is about to be drawn
+
+class MotionKernel {
+public:
+	MotionKernel();
+
+	// adds a to the kernel and records its slot in a
+	void add(Actor* a);
+
+	// removes the actor in slot by moving the last actor into it
+	void remove(int slot);
+
+	void clear();
+	int size() const;
+
+	// makes room for n actors, so adding up to that many doesn't allocate
+	void reserve(int n);
+
+	// moves every actor by its speed, less the racer's vertical speed scrollY, kills those that left the screen,
+	// and marks those that overlap racer (as overlap() in Actor.cpp)
+	// returns whether any overlap racer
+	bool update(fixed scrollY, const Actor* racer);
+
+	// the position of the actor in slot
+	fixed getX(int slot) const;
+	fixed getY(int slot) const;
+
+	// whether the actor in slot overlapped the racer as of the last update()
+	bool isTouchingRacer(int slot) const;
+
+	// moves each actor's GraphObject to where the kernel has it, if it's moved since the last call
+	void syncDrawnPositions();
+
+private:
+	std::vector<Actor*> m_actors;
+	std::vector<fixed> m_x;
+	std::vector<fixed> m_y;
+	std::vector<fixed> m_speedX;
+	std::vector<fixed> m_speedY;
+	std::vector<fixed> m_radius;
+	std::vector<int> m_flags;       // MotionFlags, as whole ints so the vector pass loads and stores them directly
+	bool m_moved;                   // since syncDrawnPositions()
+};
+
+#endif // MOTIONKERNEL_H_
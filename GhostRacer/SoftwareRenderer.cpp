@@ -0,0 +1,343 @@
+#include "SoftwareRenderer.h"
+#include "GameConstants.h"
+#include "GraphObject.h"
+#include "SpriteAssets.h"
+#include "AssetLoader.h"
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RENDER_USE_SSE2
+#endif
+using namespace std;
+
+// constants
+const uint32_t OPAQUE_BLACK = 0xFF000000;  // R, G, B = 0, A = 255
+const int TGA_HEADER_SIZE = 18;
+
+// c * a / 255, rounded to nearest, for c * a up to 255 * 255
+static inline uint32_t div255(uint32_t x) {
+	x += 128;
+	return (x + (x >> 8)) >> 8;
+}
+
+void blendSpan(uint32_t* dst, const uint32_t* src, int n) {
+	int k = 0;
+#ifdef RENDER_USE_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i alphaByte = _mm_set1_epi32(static_cast<int>(OPAQUE_BLACK));
+	const __m128i full = _mm_set1_epi16(255);
+	const __m128i half = _mm_set1_epi16(128);
+	for (; k + 4 <= n; k += 4) {
+		__m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + k));
+		__m128i a32 = _mm_srli_epi32(s, 24);
+		int opaque = _mm_movemask_epi8(_mm_cmpeq_epi32(a32, _mm_set1_epi32(255)));
+		if (opaque == 0xFFFF) {
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k), s);
+			continue;
+		}
+		if (_mm_movemask_epi8(_mm_cmpeq_epi32(a32, zero)) == 0xFFFF)
+			continue;
+
+		// each pixel's alpha in all four of its channels' 16 bit lanes
+		__m128i a16 = _mm_packs_epi32(a32, a32);
+		a16 = _mm_unpacklo_epi16(a16, a16);
+		__m128i aLo = _mm_unpacklo_epi32(a16, a16);
+		__m128i aHi = _mm_unpackhi_epi32(a16, a16);
+
+		// blend the source's alpha channel as 255, so the result's alpha is a + dst * (255 - a) / 255
+		s = _mm_or_si128(s, alphaByte);
+		__m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + k));
+
+		__m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(s, zero), aLo),
+			_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), _mm_sub_epi16(full, aLo)));
+		__m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(s, zero), aHi),
+			_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), _mm_sub_epi16(full, aHi)));
+		lo = _mm_add_epi16(lo, half);
+		hi = _mm_add_epi16(hi, half);
+		lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+		hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + k), _mm_packus_epi16(lo, hi));
+	}
+#endif
+	for (; k < n; ++k) {
+		uint32_t s = src[k];
+		uint32_t a = s >> 24;
+		if (a == 0)
+			continue;
+		if (a == 255) {
+			dst[k] = s;
+			continue;
+		}
+		s |= OPAQUE_BLACK;
+		uint32_t d = dst[k];
+		uint32_t out = 0;
+		for (int shift = 0; shift < 32; shift += 8) {
+			uint32_t c = div255(((s >> shift) & 0xFF) * a + ((d >> shift) & 0xFF) * (255 - a));
+			out |= c << shift;
+		}
+		dst[k] = out;
+	}
+}
+
+SoftwareRenderer::SoftwareRenderer(int scale) : m_scale(max(scale, 1)) {
+	m_framebuffer.width = VIEW_WIDTH * m_scale;
+	m_framebuffer.height = VIEW_HEIGHT * m_scale;
+	m_framebuffer.pixels.assign(m_framebuffer.width * m_framebuffer.height, OPAQUE_BLACK);
+	m_span.resize(m_framebuffer.width);
+}
+
+bool SoftwareRenderer::loadSprite(string tgaFile, int imageID, int frameNum) {
+	DecodedSprite sprite;
+	if (!decodeSprite(tgaFile, 0, sprite))
+		return false;
+	sprite.imageID = imageID;
+	sprite.frameNum = frameNum;
+	return addSprite(sprite);
+}
+
+bool SoftwareRenderer::addSprite(const DecodedSprite& sprite) {
+	if (sprite.levels.empty() || (sprite.components != 3 && sprite.components != 4))
+		return false;
+	const int imageID = sprite.imageID;
+	const int frameNum = sprite.frameNum;
+	const MipLevel& decoded = sprite.levels[0];
+	const int width = decoded.width;
+	const int height = decoded.height;
+	const int byteCount = sprite.components;
+
+	// the OpenGL backend puts the first row in the file at the bottom of the sprite whatever the header's origin bit says,
+	// so the first row read is the last row here
+	RgbaImage image;
+	image.width = width;
+	image.height = height;
+	image.pixels.resize(width * height);
+	for (int row = 0; row < height; ++row) {
+		const unsigned char* p = decoded.pixels.data() + row * width * byteCount;
+		uint32_t* out = image.pixels.data() + (height - 1 - row) * width;
+		for (int col = 0; col < width; ++col, p += byteCount) {
+			uint32_t a = byteCount == 4 ? p[3] : 255;
+			out[col] = p[2] | (p[1] << 8) | (p[0] << 16) | (a << 24);
+		}
+	}
+
+	vector<RgbaImage>& frames = m_sprites[imageID];
+	if (frameNum >= static_cast<int>(frames.size()))
+		frames.resize(frameNum + 1);
+	frames[frameNum] = move(image);
+	return true;
+}
+
+bool SoftwareRenderer::loadSprites(string assetPath) {
+	for (int k = 0; k < NUM_SPRITE_ASSETS; ++k) {
+		const SpriteInfo& d = SPRITE_ASSETS[k];
+		if (!loadSprite(assetPath + d.tgaFileName, d.imageID, d.frameNum))
+			return false;
+	}
+	return buildRoad();
+}
+
+int SoftwareRenderer::getNumFrames(int imageID) const {
+	auto it = m_sprites.find(imageID);
+	return it == m_sprites.end() ? 0 : static_cast<int>(it->second.size());
+}
+
+void SoftwareRenderer::collectDraws(vector<SpriteDraw>& draws) {
+	for (int i = 4 /* NUM_DEPTHS */ - 1; i >= 0; --i) {
+		for (GraphObject* cur : GraphObject::getGraphObjects(i)) {
+			if (!cur->isVisible())
+				continue;
+			cur->animate();
+
+			double x, y;
+			cur->getAnimationLocation(x, y);
+			SpriteDraw d;
+			d.imageID = cur->getID();
+			d.frame = cur->getAnimationNumber();
+			d.x = toFixed(x);
+			d.y = toFixed(y);
+			d.angle = cur->getAnimationDirection();
+			d.size = toFixed(cur->getSize());
+			d.depth = i;
+			draws.push_back(d);
+		}
+	}
+}
+
+// back to front, then anything that stays the same wherever the objects were allocated
+static bool drawsBefore(const SpriteDraw& a, const SpriteDraw& b) {
+	if (a.depth != b.depth)
+		return a.depth > b.depth;
+	if (a.y != b.y)
+		return a.y > b.y;
+	if (a.x != b.x)
+		return a.x < b.x;
+	if (a.imageID != b.imageID)
+		return a.imageID < b.imageID;
+	if (a.frame != b.frame)
+		return a.frame < b.frame;
+	if (a.angle != b.angle)
+		return a.angle < b.angle;
+	return a.size < b.size;
+}
+
+bool SoftwareRenderer::buildRoad() {
+	if (getNumFrames(IID_YELLOW_BORDER_LINE) == 0 || getNumFrames(IID_WHITE_BORDER_LINE) == 0)
+		return false;
+
+	m_road.width = m_framebuffer.width;
+	m_road.height = ROAD_TILE_HEIGHT * m_scale;
+	m_road.pixels.assign(m_road.width * m_road.height, OPAQUE_BLACK);
+
+	// a line at the tile's bottom edge is drawn again at its top edge, so the halves that overhang meet when it repeats
+	SpriteDraw d = { IID_YELLOW_BORDER_LINE, 0, 0, 0, 0, toFixed(BORDER_LINE_SIZE), 2 };
+	for (int y = 0; y <= ROAD_TILE_HEIGHT; y += SPRITE_HEIGHT) {
+		d.y = y * FIXED_ONE;
+		d.x = LEFT_BOUND * FIXED_ONE;
+		drawSprite(d, m_road);
+		d.x = RIGHT_BOUND * FIXED_ONE;
+		drawSprite(d, m_road);
+	}
+	d.imageID = IID_WHITE_BORDER_LINE;
+	for (int y = 0; y <= ROAD_TILE_HEIGHT; y += ROAD_TILE_HEIGHT) {
+		d.y = y * FIXED_ONE;
+		d.x = LEFT_MID_BOUND * FIXED_ONE;
+		drawSprite(d, m_road);
+		d.x = RIGHT_MID_BOUND * FIXED_ONE;
+		drawSprite(d, m_road);
+	}
+	return true;
+}
+
+void SoftwareRenderer::render(vector<SpriteDraw>& draws, ::fixed roadScroll) {
+	drawRoad(roadScroll);
+	sort(draws.begin(), draws.end(), drawsBefore);
+	for (const SpriteDraw& d : draws)
+		drawSprite(d, m_framebuffer);
+}
+
+void SoftwareRenderer::drawRoad(::fixed roadScroll) {
+	if (m_road.pixels.empty()) {
+		fill(m_framebuffer.pixels.begin(), m_framebuffer.pixels.end(), OPAQUE_BLACK);
+		return;
+	}
+
+	// the road at height y shows the tile at y + roadScroll
+	const int width = m_framebuffer.width;
+	const int height = m_framebuffer.height;
+	const int tileHeight = m_road.height;
+	const int scroll = static_cast<int>((static_cast<int64_t>(roadScroll) * m_scale) >> FIXED_SHIFT);
+	for (int row = 0; row < height; ++row) {
+		int y = ((height - 1 - row + scroll) % tileHeight + tileHeight) % tileHeight;
+		copy_n(m_road.pixels.data() + (tileHeight - 1 - y) * width, width, m_framebuffer.pixels.data() + row * width);
+	}
+}
+
+void SoftwareRenderer::drawSprite(const SpriteDraw& d, RgbaImage& target) {
+	auto it = m_sprites.find(d.imageID);
+	if (it == m_sprites.end() || it->second.empty())
+		return;
+	const RgbaImage& tex = it->second[d.frame % it->second.size()];
+	if (tex.pixels.empty())
+		return;
+
+	// everything in framebuffer pixels, fixed point, y up from the bottom row
+	const int64_t halfW = static_cast<int64_t>(d.size) * SPRITE_WIDTH * m_scale / 2;
+	const int64_t halfH = static_cast<int64_t>(d.size) * SPRITE_HEIGHT * m_scale / 2;
+	if (halfW <= 0 || halfH <= 0)
+		return;
+	const int64_t cx = static_cast<int64_t>(d.x) * m_scale;
+	const int64_t cy = static_cast<int64_t>(d.y) * m_scale;
+
+	// actors facing left are mirrored rather than drawn upside down, as in SpriteManager::plotSprite()
+	const bool mirror = d.angle == 180;
+	const int64_t c = fixedCos(mirror ? 0 : d.angle);
+	const int64_t s = fixedSin(mirror ? 0 : d.angle);
+	const int64_t flip = mirror ? -1 : 1;
+
+	// bounding box of the turned sprite
+	const int64_t extentX = (std::abs(c) * halfW + std::abs(s) * halfH) >> FIXED_SHIFT;
+	const int64_t extentY = (std::abs(s) * halfW + std::abs(c) * halfH) >> FIXED_SHIFT;
+	const int width = target.width;
+	const int height = target.height;
+	const int col0 = static_cast<int>(max<int64_t>((cx - extentX) >> FIXED_SHIFT, 0));
+	const int col1 = static_cast<int>(min<int64_t>((cx + extentX) >> FIXED_SHIFT, width - 1));
+	const int row0 = static_cast<int>(max<int64_t>((cy - extentY) >> FIXED_SHIFT, 0));
+	const int row1 = static_cast<int>(min<int64_t>((cy + extentY) >> FIXED_SHIFT, height - 1));
+	if (col0 > col1 || row0 > row1)
+		return;
+
+	// texels per framebuffer pixel along the sprite's own axes
+	const int64_t texPerPixelU = (static_cast<int64_t>(tex.width) << (2 * FIXED_SHIFT)) / (2 * halfW);
+	const int64_t texPerPixelV = (static_cast<int64_t>(tex.height) << (2 * FIXED_SHIFT)) / (2 * halfH);
+	const int64_t texLimitU = static_cast<int64_t>(tex.width) << FIXED_SHIFT;
+	const int64_t texLimitV = static_cast<int64_t>(tex.height) << FIXED_SHIFT;
+
+	// inverse mapping: a pixel's offset from the centre turned back by the angle gives its place on the sprite,
+	// and moving one pixel right moves the same amount across the sprite each time
+	const int64_t stepU = (flip * c * texPerPixelU) >> FIXED_SHIFT;
+	const int64_t stepV = (-s * texPerPixelV) >> FIXED_SHIFT;
+	const int64_t half = FIXED_ONE / 2;
+	const int n = col1 - col0 + 1;
+	uint32_t* span = m_span.data();
+
+	for (int row = row0; row <= row1; ++row) {
+		const int64_t dx = (static_cast<int64_t>(col0) << FIXED_SHIFT) + half - cx;
+		const int64_t dy = (static_cast<int64_t>(row) << FIXED_SHIFT) + half - cy;
+		const int64_t u = flip * ((dx * c + dy * s) >> FIXED_SHIFT);
+		const int64_t v = (dy * c - dx * s) >> FIXED_SHIFT;
+		int64_t tu = ((u + halfW) * texPerPixelU) >> FIXED_SHIFT;
+		int64_t tv = ((v + halfH) * texPerPixelV) >> FIXED_SHIFT;
+
+		bool any = false;
+		for (int k = 0; k < n; ++k, tu += stepU, tv += stepV) {
+			if (tu < 0 || tv < 0 || tu >= texLimitU || tv >= texLimitV) {
+				span[k] = 0;
+				continue;
+			}
+			int texRow = tex.height - 1 - static_cast<int>(tv >> FIXED_SHIFT);
+			span[k] = tex.pixels[texRow * tex.width + static_cast<int>(tu >> FIXED_SHIFT)];
+			any = true;
+		}
+		if (any)
+			blendSpan(target.pixels.data() + (height - 1 - row) * width + col0, span, n);
+	}
+}
+
+const RgbaImage& SoftwareRenderer::getFramebuffer() const {
+	return m_framebuffer;
+}
+
+const RgbaImage& SoftwareRenderer::getRoad() const {
+	return m_road;
+}
+
+bool SoftwareRenderer::writeTga(string file) const {
+	ofstream out(file, ios::out | ios::binary);
+	if (!out)
+		return false;
+
+	const int width = m_framebuffer.width;
+	const int height = m_framebuffer.height;
+	unsigned char header[TGA_HEADER_SIZE] = {};
+	header[2] = 2;  // uncompressed color
+	header[12] = width & 0xFF;
+	header[13] = (width >> 8) & 0xFF;
+	header[14] = height & 0xFF;
+	header[15] = (height >> 8) & 0xFF;
+	header[16] = 32;
+	header[17] = 0x28;  // 8 alpha bits, top row first
+	out.write(reinterpret_cast<const char*>(header), TGA_HEADER_SIZE);
+
+	vector<unsigned char> bgra(width * height * 4);
+	for (size_t k = 0; k < m_framebuffer.pixels.size(); ++k) {
+		uint32_t p = m_framebuffer.pixels[k];
+		bgra[4 * k] = (p >> 16) & 0xFF;
+		bgra[4 * k + 1] = (p >> 8) & 0xFF;
+		bgra[4 * k + 2] = p & 0xFF;
+		bgra[4 * k + 3] = p >> 24;
+	}
+	out.write(reinterpret_cast<const char*>(bgra.data()), bgra.size());
+	return static_cast<bool>(out);
+}
@@ -0,0 +1,89 @@
+#ifndef SOFTWARERENDERER_H_
+#define SOFTWARERENDERER_H_
+
+#include "Fixed.h"
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+// CPU rendering backend alongside the OpenGL one in GameController and SpriteManager
+// draws the same sprites displayGamePlay() does into an RGBA framebuffer in memory, with no window, GPU or X server,
+// so frames can be rendered on headless machines, compared pixel for pixel against golden images,
+// and timed apart from the driver
+// all the maths is integer (fixed point, with rotation in whole degrees from the trig table), so a frame
+// renders to the same bytes on every build
+
+struct DecodedSprite;
+
+// one sprite to draw, as displayGamePlay() passes it to SpriteManager::plotSprite()
+struct SpriteDraw {
+	int imageID;
+	int frame;      // animation number, taken modulo the image's frame count when drawn
+	fixed x;        // centre, in world coordinates
+	fixed y;
+	int angle;      // degrees counterclockwise, except that 180 mirrors instead of turning upside down
+	fixed size;
+	int depth;      // 0 is in front, drawn last
+};
+
+// a 32 bit image, one uint32_t per pixel holding bytes R, G, B, A in memory order, top row first
+struct RgbaImage {
+	int width;
+	int height;
+	std::vector<uint32_t> pixels;
+};
+
+class SoftwareRenderer {
+public:
+	// the framebuffer is VIEW_WIDTH x VIEW_HEIGHT world units at scale pixels each
+	explicit SoftwareRenderer(int scale = 3);
+
+	// loads one frame of an image from a TGA that decodeTga() reads, like SpriteManager::loadSprite()
+	bool loadSprite(std::string tgaFile, int imageID, int frameNum);
+
+	// adds a frame that decodeSprite() has already read, as its imageID and frameNum say; only its first level is used
+	bool addSprite(const DecodedSprite& sprite);
+
+	// loads every frame in SPRITE_ASSETS from assetPath, which is empty or ends in '/'
+	bool loadSprites(std::string assetPath);
+
+	int getNumFrames(int imageID) const;
+
+	// appends what displayGamePlay() would plot this frame, back to front, animating each object as it does
+	static void collectDraws(std::vector<SpriteDraw>& draws);
+
+	// prerenders the road's lines into a tile ROAD_TILE_HEIGHT tall and as wide as the view,
+	// from the Border Line sprites, which must be loaded
+	bool buildRoad();
+
+	// fills the framebuffer with the road scrolled down by roadScroll pixels (opaque black if it isn't built),
+	// then draws draws over it, back to front
+	// draws at the same depth are ordered by position so a frame doesn't depend on where objects were allocated
+	void render(std::vector<SpriteDraw>& draws, fixed roadScroll);
+
+	const RgbaImage& getFramebuffer() const;
+	const RgbaImage& getRoad() const;
+
+	// writes the framebuffer as an uncompressed 32 bit TGA, returns false if it can't
+	bool writeTga(std::string file) const;
+
+private:
+	// alpha blends one sprite into target, sampling the nearest texel
+	void drawSprite(const SpriteDraw& d, RgbaImage& target);
+
+	// copies the road's rows into the framebuffer
+	void drawRoad(fixed roadScroll);
+
+	int m_scale;
+	RgbaImage m_framebuffer;
+	RgbaImage m_road;                                // empty until buildRoad()
+	std::map<int, std::vector<RgbaImage> > m_sprites;  // frames of each image, by image ID
+	std::vector<uint32_t> m_span;                    // texels sampled for the row being blended
+};
+
+// blends n straight alpha src pixels over dst, rounding each channel to nearest
+// SSE2 four pixels at a time where it's available, with the same results as the scalar path
+void blendSpan(uint32_t* dst, const uint32_t* src, int n);
+
+#endif // SOFTWARERENDERER_H_
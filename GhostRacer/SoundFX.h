@@ -14,7 +14,7 @@ class SoundFXController
 {
   public:
 
-	void playClip(std::string soundFile)
+	void playClip(const std::string& soundFile)
 	{
 		if (m_engine != nullptr)
 			m_engine->play2D(soundFile.c_str(), false);
@@ -63,12 +63,11 @@ class SoundFXController
      : pidValid(false)
     {}
 
-    void playClip(std::string soundFile)
+    void playClip(const std::string& soundFile)
     {
         char cmd[] = "/usr/bin/afplay";
-        std::unique_ptr<char[]> fileName(new char[soundFile.size()+1]);
-        std::strcpy(fileName.get(), soundFile.c_str());
-        char* argv[] = { cmd, fileName.get(), nullptr };
+          // posix_spawn doesn't write to argv, so the path needn't be copied
+        char* argv[] = { cmd, const_cast<char*>(soundFile.c_str()), nullptr };
         abortClip();  // stop anything currently playing
         pidValid = (posix_spawn(&pid, argv[0], nullptr, nullptr, argv, nullptr) == 0);
     }
@@ -92,7 +91,7 @@ class SoundFXController
 class SoundFXController
 {
   public:
-    void playClip(std::string) {}
+    void playClip(const std::string&) {}
     void abortClip() {}
     static SoundFXController& getInstance();
 };
@@ -0,0 +1,38 @@
+#ifndef SPRITEASSETS_H_
+#define SPRITEASSETS_H_
+
+#include "GameConstants.h"
+
+  // Which TGA file in the Assets directory holds each frame of each image
+  // shared by the OpenGL sprite manager and the software renderer so both load the same frames
+
+struct SpriteInfo
+{
+	unsigned int imageID;
+	unsigned int frameNum;
+	const char*	 tgaFileName;
+};
+
+const SpriteInfo SPRITE_ASSETS[] = {
+	{ IID_GHOST_RACER	 , 0, "redcar.tga" },
+	{ IID_WHITE_BORDER_LINE	 , 0, "white-lane.tga" },
+	{ IID_YELLOW_BORDER_LINE , 0, "yellow-lane.tga" },
+	{ IID_OIL_SLICK	, 0, "oil.tga" },
+	{ IID_HUMAN_PED	, 0, "dude_1.tga" },
+	{ IID_HUMAN_PED	, 1, "dude_2.tga" },
+	{ IID_HUMAN_PED	, 2, "dude_3.tga" },
+	{ IID_ZOMBIE_PED	, 0, "zombie_1.tga" },
+	{ IID_ZOMBIE_PED	, 1, "zombie_2.tga" },
+	{ IID_ZOMBIE_PED	, 2, "zombie_3.tga" },
+	{ IID_ZOMBIE_CAB		   , 0, "yellow.tga" },
+	{ IID_HOLY_WATER_PROJECTILE	   , 0, "water1.tga" },
+	{ IID_HOLY_WATER_PROJECTILE	   , 1, "water2.tga" },
+	{ IID_HOLY_WATER_PROJECTILE	   , 2, "water3.tga" },
+	{ IID_HEAL_GOODIE  , 0, "health.tga"},
+	{ IID_HOLY_WATER_GOODIE  , 0, "holy_water.tga"},
+	{ IID_SOUL_GOODIE  , 0, "soul.tga"},
+};
+
+const int NUM_SPRITE_ASSETS = sizeof(SPRITE_ASSETS) / sizeof(SPRITE_ASSETS[0]);
+
+#endif // SPRITEASSETS_H_
@@ -12,11 +12,13 @@
 #endif
 
 #include "GameConstants.h"
+#include "AssetLoader.h"
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <map>
 #include <memory>
+#include <algorithm>
 
 class SpriteManager
 {
@@ -32,50 +34,43 @@ public:
 		m_mipMapped = status;
 	}
 
+	  // The largest mipmap side sprites should be decoded with for this manager, or 0 if it doesn't mipmap
+	  // asks OpenGL, so call it from the thread that owns the context
+	int getMaxMipSize() const
+	{
+		if (!m_mipMapped)
+			return 0;
+		GLint maxSize = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+		return maxSize;
+	}
+
 	bool loadSprite(std::string filename_tga, int imageID, int frameNum)
 	{
 		  // Load Texture Data From TGA File
-
-		unsigned int spriteID = getSpriteID(imageID, frameNum);
-		if (INVALID_SPRITE_ID == spriteID)
-			return false;
-
-		m_frameCountPerSprite[imageID]++;	// keep track of how many frames per sprite we loaded
-
-		std::string line;
-		std::string contents = "";
-		std::ifstream tgaFile(filename_tga, std::ios::in|std::ios::binary);
-
-		if (!tgaFile)
+		DecodedSprite sprite;
+		sprite.imageID = imageID;
+		sprite.frameNum = frameNum;
+		if (!decodeSprite(filename_tga, getMaxMipSize(), sprite))
+		{
+			m_frameCountPerSprite[imageID]++;
 			return false;
+		}
+		return uploadSprite(sprite);
+	}
 
-		char type[3];
-		char info[6];
-        
-          // Read file header info
-        tgaFile.read(type, 3);
-        tgaFile.seekg(12);
-        tgaFile.read(info, 6);
-        unsigned int textureWidth = static_cast<unsigned char>(info[0]) + static_cast<unsigned char>(info[1]) * 256;
-        unsigned int textureHeight = static_cast<unsigned char>(info[2]) + static_cast<unsigned char>(info[3]) * 256;
-        unsigned char byteCount = static_cast<unsigned char>(info[4]) / 8;
-        long imageSize = textureWidth * textureHeight * byteCount;
-        std::unique_ptr<char[]> imageData(new char[imageSize]);
-        tgaFile.seekg(18);
-          // Read image data
-		tgaFile.read(imageData.get(), imageSize);
-		if (!tgaFile)
+	  // Transfer a sprite that decodeSprite() has read (with this manager's getMaxMipSize()) to OpenGL
+	bool uploadSprite(const DecodedSprite& sprite)
+	{
+		unsigned int spriteID = getSpriteID(sprite.imageID, sprite.frameNum);
+		if (static_cast<unsigned int>(INVALID_SPRITE_ID) == spriteID)
 			return false;
 
-		  //image type either 2 (color) or 3 (greyscale)
-		if (type[1] != 0 || (type[2] != 2 && type[2] != 3))
-			return false;
+		m_frameCountPerSprite[sprite.imageID]++;	// keep track of how many frames per sprite we loaded
 
-		if (byteCount != 3 && byteCount != 4)
+		if (sprite.levels.empty()  ||  (sprite.components != 3  &&  sprite.components != 4))
 			return false;
 
-		  // Transfer Texture To OpenGL
-
 		glEnable(GL_DEPTH_TEST);
 
 		  // allocate a texture handle
@@ -104,19 +99,14 @@ public:
 		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, static_cast<GLfloat>(GL_REPEAT));
 		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, static_cast<GLfloat>(GL_REPEAT));
 
-		if (m_mipMapped)
-		{
-			  // build our texture mipmaps
-			  // byteCount of 3 means that BGR data is being supplied. byteCount of 4 means that BGRA data is being supplied.
-            makeMipmaps(byteCount, textureWidth, textureHeight, imageData.get());
-        }
-		else
+		  // components of 3 means that BGR data is being supplied. components of 4 means that BGRA data is being supplied.
+		  // the mipmaps were built with the pixels, so each level is only a copy
+		int format = (sprite.components == 3 ? GL_BGR : GL_BGRA);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		for (size_t level = 0; level < sprite.levels.size(); level++)
 		{
-			  // byteCount of 3 means that BGR data is being supplied. byteCount of 4 means that BGRA data is being supplied.
-			if (3 == byteCount)
-				glTexImage2D(GL_TEXTURE_2D, 0, 3, textureWidth, textureHeight, 0, GL_BGR, GL_UNSIGNED_BYTE, imageData.get());
-			else if (4 == byteCount)
-				glTexImage2D(GL_TEXTURE_2D, 0, 4, textureWidth, textureHeight, 0, GL_BGRA, GL_UNSIGNED_BYTE, imageData.get());
+			const MipLevel& mip = sprite.levels[level];
+			glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), sprite.components, mip.width, mip.height, 0, format, GL_UNSIGNED_BYTE, mip.pixels.data());
 		}
 
 		m_imageMap[spriteID] = glTextureID;
@@ -124,6 +114,37 @@ public:
 		return true;
 	}
 
+	  // Load a width x height image of RGBA pixels, top row first, that was made in memory rather than read from a file
+	bool loadImage(int imageID, int frameNum, int width, int height, const unsigned char* rgba)
+	{
+		unsigned int spriteID = getSpriteID(imageID, frameNum);
+		if (static_cast<unsigned int>(INVALID_SPRITE_ID) == spriteID)
+			return false;
+
+		m_frameCountPerSprite[imageID]++;
+
+		  // OpenGL wants the bottom row first
+		const size_t rowBytes = static_cast<size_t>(width) * 4;
+		std::unique_ptr<unsigned char[]> flipped(new unsigned char[rowBytes * height]);
+		for (int row = 0; row < height; row++)
+			std::copy(rgba + row * rowBytes, rgba + (row + 1) * rowBytes, flipped.get() + (height - 1 - row) * rowBytes);
+
+		GLuint glTextureID;
+		glGenTextures(1, &glTextureID);
+		glBindTexture(GL_TEXTURE_2D, glTextureID);
+		glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, static_cast<GLfloat>(GL_REPEAT));
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, static_cast<GLfloat>(GL_REPEAT));
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexImage2D(GL_TEXTURE_2D, 0, 4, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, flipped.get());
+
+		m_imageMap[spriteID] = glTextureID;
+
+		return true;
+	}
+
 	unsigned int getNumFrames(int imageID) const
 	{
 		auto it = m_frameCountPerSprite.find(imageID);
@@ -237,6 +258,43 @@ public:
 		return true;
 	}
 
+	  // Draw frame 0 of imageID as one quad from (gx1, gy1) at the bottom left to (gx2, gy2) at the top right, at depth gz,
+	  // with the texture repeating up the quad from t1 at its bottom to t2 at its top, for scrolling backgrounds
+	bool plotScrolling(int imageID, double gx1, double gy1, double gx2, double gy2, double gz, double t1, double t2)
+	{
+		auto it = m_imageMap.find(getSpriteID(imageID, 0));
+		if (it == m_imageMap.end())
+			return false;
+
+		glPushMatrix();
+		glTranslatef(0, 0, static_cast<GLfloat>(gz));
+		glPushAttrib(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glEnable(GL_TEXTURE_2D);
+		glDisable(GL_DEPTH_TEST);
+		glBindTexture(GL_TEXTURE_2D, it->second);
+
+		glColor3f(1.0, 1.0, 1.0);
+
+		glBegin(GL_QUADS);
+		glTexCoord2d(0, t1);
+		glVertex3f(static_cast<GLfloat>(gx1), static_cast<GLfloat>(gy1), 0);
+		glTexCoord2d(1, t1);
+		glVertex3f(static_cast<GLfloat>(gx2), static_cast<GLfloat>(gy1), 0);
+		glTexCoord2d(1, t2);
+		glVertex3f(static_cast<GLfloat>(gx2), static_cast<GLfloat>(gy2), 0);
+		glTexCoord2d(0, t2);
+		glVertex3f(static_cast<GLfloat>(gx1), static_cast<GLfloat>(gy2), 0);
+		glEnd();
+
+		glDisable(GL_TEXTURE_2D);
+		glEnable(GL_DEPTH_TEST);
+
+		glPopAttrib();
+		glPopMatrix();
+
+		return true;
+	}
+
 	~SpriteManager()
 	{
 		for (auto it = m_imageMap.begin(); it != m_imageMap.end(); it++)
@@ -267,18 +325,6 @@ private:
 
 		return imageID * MAX_FRAMES_PER_SPRITE + frame;
 	}
-
-    static void makeMipmaps(unsigned char byteCount, unsigned int textureWidth, unsigned int textureHeight, char* imageData)
-    {
-        int format = (byteCount == 3 ? GL_BGR : GL_BGRA);
-#ifdef __APPLE__
-        int internalFormat = (byteCount == 3 ? GL_RGB : GL_RGBA);
-        glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, textureWidth, textureHeight, 0, format, GL_UNSIGNED_BYTE, imageData);
-        glGenerateMipmap(GL_TEXTURE_2D);
-#else
-        gluBuild2DMipmaps(GL_TEXTURE_2D, byteCount, textureWidth, textureHeight, format, GL_UNSIGNED_BYTE, imageData);
-#endif
-    }
 };
 
 #endif // SPRITEMANAGER_H_
@@ -1,10 +1,51 @@
 #include "StudentWorld.h"
 #include "GameConstants.h"
 #include "Actor.h"
+#include "Metrics.h"
+#include "AllocStats.h"
+#include "ActorPool.h"
 #include <string>
-#include <sstream>
+#include <cstdio>
+#include <algorithm>
+#include <chrono>
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OBS_USE_SSE2
+#endif
 using namespace std;
 
+const int STATUS_TEXT_SIZE = 160;	// longer than the status line can get
+const int RESERVED_ACTORS = 64;		// of each type, more than a level keeps in play at once
+
+// adds the time from construction to destruction to total, and the number of items timed to count, if enabled
+// used for the stress scenario stats
+class StressTimer {
+public:
+	StressTimer(bool enabled, double& total, long long& count)
+		: m_enabled(enabled), m_total(total), m_count(count), m_items(1) {
+		if (m_enabled)
+			m_start = chrono::steady_clock::now();
+	}
+
+	~StressTimer() {
+		if (m_enabled) {
+			m_total += chrono::duration<double, nano>(chrono::steady_clock::now() - m_start).count();
+			m_count += m_items;
+		}
+	}
+
+	void setItems(long long items) {
+		m_items = items;
+	}
+
+private:
+	bool m_enabled;
+	double& m_total;
+	long long& m_count;
+	long long m_items;
+	chrono::steady_clock::time_point m_start;
+};
+
 GameWorld* createStudentWorld(string assetPath)
 {
 	return new StudentWorld(assetPath);
@@ -15,10 +56,33 @@ GameWorld* createStudentWorld(string assetPath)
 StudentWorld::StudentWorld(string assetPath)
 : GameWorld(assetPath)
 {
-	m_yellow = VIEW_HEIGHT / SPRITE_HEIGHT;
-	m_white = VIEW_HEIGHT / (4 * SPRITE_HEIGHT);
+	m_roadScroll = 0;
 	m_souls = 0;
 	m_bonus = 5000;
+	m_ticks = 0;
+	m_levelsLoaded = false;
+	m_levelDef = defaultLevel(1);
+	m_autopilotOn = false;
+	m_autopilotMoved = false;
+	m_racer = nullptr;
+	m_stress = false;
+	resetStressStats();
+	m_statusText.reserve(STATUS_TEXT_SIZE);
+
+	// room for each type's actors up front, so the collections and the pool don't grow in the middle of play
+	m_humans.reserve(RESERVED_ACTORS);
+	m_zombies.reserve(RESERVED_ACTORS);
+	m_cabs.reserve(RESERVED_ACTORS);
+	m_oils.reserve(RESERVED_ACTORS);
+	m_heals.reserve(RESERVED_ACTORS);
+	m_holyWaters.reserve(RESERVED_ACTORS);
+	m_lostSouls.reserve(RESERVED_ACTORS);
+	m_sprays.reserve(RESERVED_ACTORS);
+	m_motion.reserve(RESERVED_ACTORS * 4);	// Oil Slicks and the three Goodies
+	const size_t sizes[] = { sizeof(GhostRacer), sizeof(Human), sizeof(Zombie), sizeof(Cab), sizeof(Oil), sizeof(Heal),
+		sizeof(HolyWater), sizeof(Soul), sizeof(Spray) };
+	for (size_t size : sizes)
+		ActorPool::reserve(size, RESERVED_ACTORS);
 }
 
 StudentWorld::~StudentWorld() {
@@ -27,110 +91,133 @@ StudentWorld::~StudentWorld() {
 
 int StudentWorld::init()
 {
-	m_souls = 0;
-	m_bonus = 5000;
-	m_racer = new GhostRacer(this);
-	m_actors.resize(0);
-
-	// yellow boundaries
-	// set left boundary then right boundary
-	for (int y = 0; y < m_yellow; ++y) {
-		addActor(new BorderLine(IID_YELLOW_BORDER_LINE, LEFT_BOUND, y * SPRITE_HEIGHT, this));
-		addActor(new BorderLine(IID_YELLOW_BORDER_LINE, RIGHT_BOUND, y * SPRITE_HEIGHT, this));
+	// level definitions are parsed once, then each level's row is looked up here
+	if (!m_levelsLoaded) {
+		string path = assetPath();
+		if (!path.empty() && path[path.size() - 1] != '/')
+			path += '/';
+		if (!loadLevels(path + "levels.txt", m_levelDefs))
+			return GWSTATUS_LEVEL_ERROR;
+		m_levelsLoaded = true;
 	}
+	if (getLevel() <= static_cast<int>(m_levelDefs.size()))
+		m_levelDef = m_levelDefs[getLevel() - 1];
+	else
+		m_levelDef = defaultLevel(getLevel());
 
-	// white boundaries
-	// set left-middle boundary then right-middle boundary
-	for (int w = 0; w < m_white; ++w) {
-		addActor(new BorderLine(IID_WHITE_BORDER_LINE, LEFT_MID_BOUND, w * 4 * SPRITE_HEIGHT, this));
-		addActor(new BorderLine(IID_WHITE_BORDER_LINE, RIGHT_MID_BOUND, w * 4 * SPRITE_HEIGHT, this));
-	}
+	m_souls = 0;
+	m_bonus = m_levelDef.bonus;
+	allocStats().levelStarted();
+	m_racer = new GhostRacer();
+	logEvent(GAMEPLAY_LEVEL_STARTED, m_racer, getLevel());
+
+	// white dashes start at the bottom of the view, as the first Border Lines used to
+	m_roadScroll = 0;
 
-	m_lastWhiteY = (m_white - 1) * 4 * SPRITE_HEIGHT;
+	if (m_stress)
+		sustainScenario();
 
 	return GWSTATUS_CONTINUE_GAME;
 }
 
 int StudentWorld::move()
 {
-	if (!m_racer->alive()) {
+	TickMetric tickMetric;
+	AllocTick allocTick;
+	m_autopilotMoved = false;
+	++m_ticks;
+
+	if (!racerInPlay()) {
 		decLives();
 		return GWSTATUS_PLAYER_DIED;
 	}
 
-	m_racer->doSomething();
-
-	for (auto i = m_actors.begin(); m_racer->alive() && i != m_actors.end();) {
-		// if saved enough souls, return GWSTATUS_FINISHED_LEVEL
-		if (m_souls == getLevel() * 2 + 5) {
-			increaseScore(m_bonus);
-
-			return GWSTATUS_FINISHED_LEVEL;
-		}
-
-		if ((*i)->alive()) {
-			(*i)->doSomething();
-		}
-		if (!(*i)->alive()) {
-			delete *i;
-			i = m_actors.erase(i);
-		}
-		else {
-			++i;
-		}
+	// nothing an actor posts takes effect until every actor has updated, so update order doesn't matter
+	m_racer->doSomething(*this);
+
+	// scroll Goodies all at once, before anything interacts with them, finding any the racer reached on the way
+	bool touching = m_motion.update(m_racer->getFixedSpeedY(), m_racer);
+
+	// the road moves down 4 pixels a tick plus the racer's speed, like the Border Lines it replaced
+	const int tile = ROAD_TILE_HEIGHT * FIXED_ONE;
+	m_roadScroll = ((m_roadScroll + 4 * FIXED_ONE + m_racer->getFixedSpeedY()) % tile + tile) % tile;
+
+	// each type in turn
+	updateAll(m_humans);
+	updateAll(m_zombies);
+	updateAll(m_cabs);
+	if (touching) {
+		collectTouching(m_oils);
+		collectTouching(m_heals);
+		collectTouching(m_holyWaters);
+		collectTouching(m_lostSouls);
+	}
+	for (Soul* s : m_lostSouls) {
+		if (s->alive())
+			s->spin();
+	}
+	updateAll(m_sprays);
+
+	applyEvents();
+
+	// log and delete everything that died this tick, however it died
+	if (!m_racer->alive())
+		logEvent(GAMEPLAY_DEATH, m_racer, m_racer->getDeathCause());
+	removeDead(m_humans);
+	removeDead(m_zombies);
+	removeDead(m_cabs);
+	removeDead(m_oils);
+	removeDead(m_heals);
+	removeDead(m_holyWaters);
+	removeDead(m_lostSouls);
+	removeDead(m_sprays);
+	countLiveActors();
+
+	// if saved enough souls, return GWSTATUS_FINISHED_LEVEL
+	if (racerInPlay() && m_souls >= m_levelDef.soulsToSave) {
+		logEvent(GAMEPLAY_LEVEL_FINISHED, m_racer, m_bonus);
+		logEvent(GAMEPLAY_SCORE, m_racer, m_bonus);
+		increaseScore(m_bonus);
+
+		return GWSTATUS_FINISHED_LEVEL;
 	}
 
-	if (!m_racer->alive()) {
+	if (!racerInPlay()) {
 		decLives();
 		return GWSTATUS_PLAYER_DIED;
 	}
 
-	// add new Border Lines
-	double newY = VIEW_HEIGHT - SPRITE_HEIGHT;
-	m_lastWhiteY += (-4 - getRacer()->getSpeedY());
-	double delY = newY - m_lastWhiteY;
-	if (delY >= SPRITE_HEIGHT) {
-		addActor(new BorderLine(IID_YELLOW_BORDER_LINE, LEFT_BOUND, newY, this));
-		addActor(new BorderLine(IID_YELLOW_BORDER_LINE, RIGHT_BOUND, newY, this));
-	}
-	if (delY >= 4 * SPRITE_HEIGHT) {
-		addActor(new BorderLine(IID_WHITE_BORDER_LINE, LEFT_MID_BOUND, newY, this));
-		addActor(new BorderLine(IID_WHITE_BORDER_LINE, RIGHT_MID_BOUND, newY, this));
-		m_lastWhiteY = newY;
-	}
+	// spawn chances come from this level's definition
+	const int* chance = m_levelDef.spawnChance;
 
-	// add Human Pedestrian for chance [0, humChance)
-	int humChance = max(200 - getLevel() * 10, 30);
-	if (randInt(0, humChance - 1) == 0) {
-		addActor(new Human(randInt(0, VIEW_WIDTH), VIEW_HEIGHT, this));
+	// add Human Pedestrian for chance [0, chance[SPAWN_HUMAN])
+	if (randInt(0, chance[SPAWN_HUMAN] - 1) == 0) {
+		addActor(new Human(randInt(0, VIEW_WIDTH), VIEW_HEIGHT));
 	}
 
-	// add Zombie Pedestrian for chance [0, zombChance)
-	int zombChance = max(100 - getLevel() * 10, 30);
-	if (randInt(0, zombChance - 1) == 0) {
-		addActor(new Zombie(randInt(0, VIEW_WIDTH), VIEW_HEIGHT, this));
+	// add Zombie Pedestrian for chance [0, chance[SPAWN_ZOMBIE])
+	if (randInt(0, chance[SPAWN_ZOMBIE] - 1) == 0) {
+		addActor(new Zombie(randInt(0, VIEW_WIDTH), VIEW_HEIGHT));
 	}
 
-	int cabChance = max(100 - getLevel() * 10, 20);
 	int lane = randInt(0, 2);
-	// possibly add Zombie Cab for chance [0, cabChance)
-	if (randInt(0, cabChance - 1) == 0) {
+	// possibly add Zombie Cab for chance [0, chance[SPAWN_CAB])
+	if (randInt(0, chance[SPAWN_CAB] - 1) == 0) {
 		// repeat up to 3 times (once for each lane)
 		for (int l = 0; l < 3; ++l) {
 			double minY = -1, maxY = -1;;
-			// parse actors for collision avoidance-worthy actors in lane
-			for (auto a = m_actors.begin(); a != m_actors.end(); ++a) {
-				if ((*a)->collidable()) {
-					if (inLane(lane, *a)) {
-						if (minY == -1 || (*a)->getY() < minY) {
-							minY = (*a)->getY();
-						}
-						if ((*a)->getY() > maxY) {
-							maxY = (*a)->getY();
-						}
+			// parse collision avoidance-worthy actors in lane
+			findInteracting<CAT_CAB>([&](const Actor* a) {
+				if (inLane(lane, a)) {
+					if (minY == -1 || a->getY() < minY) {
+						minY = a->getY();
+					}
+					if (a->getY() > maxY) {
+						maxY = a->getY();
 					}
 				}
-			}
+				return false;
+			});
 			// check if racer is in lane
 			if (inLane(lane, m_racer)) {
 				if (minY == -1 || m_racer->getY() < minY) {
@@ -141,26 +228,26 @@ int StudentWorld::move()
 			// collision avoidance-worthy actor does not exist for lane/not too near bottom
 			if (minY == -1 || minY > VIEW_HEIGHT / 3.0) {
 				if (lane == LEFT_LANE) {
-					addActor(new Cab(ROAD_LEFT, SPRITE_HEIGHT / 2, m_racer->getSpeedY() + randInt(2, 4), LEFT_LANE, this));
+					addActor(new Cab(ROAD_LEFT, SPRITE_HEIGHT / 2, m_racer->getSpeedY() + randInt(m_levelDef.cabMinSpeed, m_levelDef.cabMaxSpeed), LEFT_LANE));
 				}
 				else if (lane == MIDDLE_LANE) {
-					addActor(new Cab(ROAD_CENTER, SPRITE_HEIGHT / 2, m_racer->getSpeedY() + randInt(2, 4), MIDDLE_LANE, this));
+					addActor(new Cab(ROAD_CENTER, SPRITE_HEIGHT / 2, m_racer->getSpeedY() + randInt(m_levelDef.cabMinSpeed, m_levelDef.cabMaxSpeed), MIDDLE_LANE));
 				}
 				else {	// lane == RIGHT_LANE
-					addActor(new Cab(ROAD_RIGHT, SPRITE_HEIGHT / 2, m_racer->getSpeedY() + randInt(2, 4), RIGHT_LANE, this));
+					addActor(new Cab(ROAD_RIGHT, SPRITE_HEIGHT / 2, m_racer->getSpeedY() + randInt(m_levelDef.cabMinSpeed, m_levelDef.cabMaxSpeed), RIGHT_LANE));
 				}
 				break;
 			}
 			// collision avoidance-worthy actor does not exist for lane/not too near top
 			if (maxY == -1 || maxY < VIEW_HEIGHT * 2 / 3.0) {
 				if (lane == LEFT_LANE) {
-					addActor(new Cab(ROAD_LEFT, VIEW_HEIGHT - SPRITE_HEIGHT / 2, m_racer->getSpeedY() - randInt(2, 4), LEFT_LANE, this));
+					addActor(new Cab(ROAD_LEFT, VIEW_HEIGHT - SPRITE_HEIGHT / 2, m_racer->getSpeedY() - randInt(m_levelDef.cabMinSpeed, m_levelDef.cabMaxSpeed), LEFT_LANE));
 				}
 				else if (lane == MIDDLE_LANE) {
-					addActor(new Cab(ROAD_CENTER, VIEW_HEIGHT - SPRITE_HEIGHT / 2, m_racer->getSpeedY() - randInt(2, 4), MIDDLE_LANE, this));
+					addActor(new Cab(ROAD_CENTER, VIEW_HEIGHT - SPRITE_HEIGHT / 2, m_racer->getSpeedY() - randInt(m_levelDef.cabMinSpeed, m_levelDef.cabMaxSpeed), MIDDLE_LANE));
 				}
 				else {	// lane == RIGHT_LANE
-					addActor(new Cab(ROAD_RIGHT, VIEW_HEIGHT - SPRITE_HEIGHT / 2, m_racer->getSpeedY() - randInt(2, 4), RIGHT_LANE, this));
+					addActor(new Cab(ROAD_RIGHT, VIEW_HEIGHT - SPRITE_HEIGHT / 2, m_racer->getSpeedY() - randInt(m_levelDef.cabMinSpeed, m_levelDef.cabMaxSpeed), RIGHT_LANE));
 				}
 				break;
 			}
@@ -172,51 +259,136 @@ int StudentWorld::move()
 		}
 	}
 	
-	// add Oil Slick for chance [0, oilChance)
-	int oilChance = max(150 - getLevel() * 10, 40);
-	if (randInt(0, oilChance - 1) == 0) {
-		addActor(new Oil(randInt(LEFT_BOUND, RIGHT_BOUND), VIEW_HEIGHT, this));
+	// add Oil Slick for chance [0, chance[SPAWN_OIL])
+	if (randInt(0, chance[SPAWN_OIL] - 1) == 0) {
+		addActor(new Oil(randInt(LEFT_BOUND, RIGHT_BOUND), VIEW_HEIGHT));
 	}
 
-	// add Holy Water Goodie for chance [0, waterChance)
-	int waterChance = 100 + 10 * getLevel();
-	if (randInt(0, waterChance - 1) == 0) {
-		addActor(new HolyWater(randInt(LEFT_BOUND, RIGHT_BOUND), VIEW_HEIGHT, this));
+	// add Holy Water Goodie for chance [0, chance[SPAWN_HOLY_WATER])
+	if (randInt(0, chance[SPAWN_HOLY_WATER] - 1) == 0) {
+		addActor(new HolyWater(randInt(LEFT_BOUND, RIGHT_BOUND), VIEW_HEIGHT));
 	}
 
-	// add Lost Soul Goodie for chance [0, 100)
-	if (randInt(0, 99) == 0) {
-		addActor(new Soul(randInt(LEFT_BOUND, RIGHT_BOUND), VIEW_HEIGHT, this));
+	// add Lost Soul Goodie for chance [0, chance[SPAWN_SOUL])
+	if (randInt(0, chance[SPAWN_SOUL] - 1) == 0) {
+		addActor(new Soul(randInt(LEFT_BOUND, RIGHT_BOUND), VIEW_HEIGHT));
 	}
 
+	if (m_stress)
+		sustainScenario();
+
 	// decrement bonus if possible
 	if(m_bonus > 0)
 		--m_bonus;
 
-	// update game status string
-	ostringstream status;
-	status << "Score: " << getScore() << "  Lvl: " << getLevel() << "  Souls2Save: " << getLevel() * 2 + 5 - m_souls
-		<< "  Lives: " << getLives() << "  Health: " << m_racer->getHP() << "  Sprays: " << m_racer->getSprays() << "  Bonus: " << m_bonus;
+	// update game status string, unless no frame will show this tick
+	// formatted into a buffer and copied into a string that keeps its capacity, so it doesn't allocate once warm
+	if (isTickShown()) {
+		AllocScope scope(ALLOC_STATUS_TEXT);
+		char status[STATUS_TEXT_SIZE];
+		snprintf(status, sizeof(status), "Score: %d  Lvl: %d  Souls2Save: %d  Lives: %d  Health: %d  Sprays: %d  Bonus: %d",
+			getScore(), getLevel(), m_levelDef.soulsToSave - m_souls, getLives(), m_racer->getHP(), m_racer->getSprays(), m_bonus);
+		m_statusText = status;
 
-	setGameStatText(status.str());
+		setGameStatText(m_statusText);
+	}
 
 	return GWSTATUS_CONTINUE_GAME;
 }
 
 void StudentWorld::cleanUp()
 {
-	for (auto i = m_actors.begin(); i != m_actors.end(); ++i) {
-		delete (*i);
+	forEachActor([](Actor* a) { delete a; });
+	m_humans.clear();
+	m_zombies.clear();
+	m_cabs.clear();
+	m_oils.clear();
+	m_heals.clear();
+	m_holyWaters.clear();
+	m_lostSouls.clear();
+	m_sprays.clear();
+	m_motion.clear();
+
+	// events posted outside move() were never applied
+	for (int k = 0; k < m_events.size(); ++k) {
+		if (m_events[k].type == EVENT_SPAWN)
+			delete m_events[k].actor;
 	}
+	m_events.clear();
 	delete m_racer;
+	m_racer = nullptr;
 }
 
 void StudentWorld::addActor(Actor* a) {
-	m_actors.push_back(a);
+	// the image ID identifies the concrete type
+	switch (a->getImageID()) {
+	case IID_HUMAN_PED:				m_humans.push_back(static_cast<Human*>(a));				break;
+	case IID_ZOMBIE_PED:			m_zombies.push_back(static_cast<Zombie*>(a));			break;
+	case IID_ZOMBIE_CAB:			m_cabs.push_back(static_cast<Cab*>(a));					break;
+	case IID_OIL_SLICK:				m_oils.push_back(static_cast<Oil*>(a));					break;
+	case IID_HEAL_GOODIE:			m_heals.push_back(static_cast<Heal*>(a));				break;
+	case IID_HOLY_WATER_GOODIE:		m_holyWaters.push_back(static_cast<HolyWater*>(a));		break;
+	case IID_SOUL_GOODIE:			m_lostSouls.push_back(static_cast<Soul*>(a));			break;
+	case IID_HOLY_WATER_PROJECTILE:	m_sprays.push_back(static_cast<Spray*>(a));				break;
+	}
+
+	if (a->getImageID() == IID_HOLY_WATER_PROJECTILE)
+		logEvent(GAMEPLAY_SPRAY_FIRED, a, m_racer != nullptr ? m_racer->getSprays() : 0);
+	else
+		logEvent(GAMEPLAY_SPAWN, a, 0);
+
+	// actors that only scroll with the road are moved by the kernel
+	switch (a->getImageID()) {
+	case IID_OIL_SLICK:
+	case IID_HEAL_GOODIE:
+	case IID_SOUL_GOODIE:
+	case IID_HOLY_WATER_GOODIE:
+		m_motion.add(a);
+		break;
+	}
+}
+
+EventBuffer& StudentWorld::events() {
+	return m_events;
+}
+
+void StudentWorld::logEvent(GameplayEventType type, const Actor* a, int value) {
+	switch (type) {
+	case GAMEPLAY_SPAWN:
+	case GAMEPLAY_SPRAY_FIRED:	metrics().actorSpawned(a->getImageID());	break;
+	case GAMEPLAY_DEATH:		metrics().actorDied(a->getImageID());		break;
+	default:																break;
+	}
+
+	GameplayLog& log = gameplayLog();
+	if (log.isOpen())
+		log.record(m_ticks, type, a->getImageID(), fixedXOf(a), fixedYOf(a), value);
+}
+
+bool StudentWorld::getInput(int& value) {
+	// TAB toggles the autopilot, and keys hit while it's driving are dropped
+	int key;
+	while (getKey(key)) {
+		if (key == KEY_PRESS_TAB)
+			m_autopilotOn = !m_autopilotOn;
+		else if (!m_autopilotOn) {
+			value = key;
+			return true;
+		}
+	}
+
+	// the autopilot makes one move a tick
+	if (!m_autopilotOn || m_autopilotMoved)
+		return false;
+	m_autopilotMoved = true;
+	PlanState root;
+	getPlanState(root);
+	value = m_autopilot.plan(root);
+	return value != 0;
 }
 
-void StudentWorld::savedSoul() {
-	++m_souls;
+void StudentWorld::setAutopilot(bool on) {
+	m_autopilotOn = on;
 }
 
 // getters
@@ -225,36 +397,452 @@ GhostRacer* StudentWorld::getRacer() const
 	return m_racer;
 }
 
+double StudentWorld::getRoadScroll() const {
+	return fromFixed(m_roadScroll);
+}
+
+void StudentWorld::syncDrawnPositions() {
+	m_motion.syncDrawnPositions();
+}
+
+const LevelDef& StudentWorld::getLevelDef() const {
+	return m_levelDef;
+}
+
+int StudentWorld::getNumActors() const {
+	return static_cast<int>(m_humans.size() + m_zombies.size() + m_cabs.size() + m_oils.size() + m_heals.size()
+		+ m_holyWaters.size() + m_lostSouls.size() + m_sprays.size());
+}
+
 int StudentWorld::checkCabFrontOrBack(int lane, const Actor* a) const {
 	// lane is lane of cab, a is pointer to the cab
-
-	for (auto i = m_actors.begin(); i != m_actors.end(); ++i) {
-		if ((*i) != a && (*i)->collidable()) {
-			if (inLane(lane, *i) && (*i)->getY() > a->getY() && (*i)->getY() - a->getY() < 96) {
-				return 0;	// actor < 96 pixels in front of cab
+	StressTimer timer(m_stress, m_stressStats.cabCheckNs, m_stressStats.cabChecks);
+	int result = -1;
+	findInteracting<CAT_CAB>([&](const Actor* i) {
+		if (i != a) {
+			if (inLane(lane, i) && i->getY() > a->getY() && i->getY() - a->getY() < 96) {
+				result = 0;	// actor < 96 pixels in front of cab
 			}
-			if (inLane(lane, *i) && a->getY() > (*i)->getY() && a->getY() - (*i)->getY() < 96) {
-				return 1;	// actor > 96 pixels behind cab
+			else if (inLane(lane, i) && a->getY() > i->getY() && a->getY() - i->getY() < 96) {
+				result = 1;	// actor > 96 pixels behind cab
 			}
 		}
-	}
+		return result != -1;
+	});
 
-	return -1;
+	return result;
 }
 
 bool StudentWorld::activatedSpray(Actor* a) {
-	for (auto i = m_actors.begin(); i != m_actors.end(); ++i) {
-		if (overlap(*i, a) && (*i)->sprayable()) {
-			(*i)->damage(1);
-			a->kill();
+	StressTimer timer(m_stress, m_stressStats.sprayCheckNs, m_stressStats.sprayChecks);
+	return findInteracting<CAT_SPRAY>([&](Actor* i) {
+		if (i->alive() && overlap(fixedXOf(i), fixedYOf(i), i->getFixedRadius(), a)) {
+			m_events.damage(i, 1);
+			a->kill(DEATH_USED_UP);
 			return true;
 		}
+		return false;
+	});
+}
+
+void StudentWorld::setScenario(const StressScenario& scenario) {
+	m_stress = true;
+	m_scenario = scenario;
+}
+
+const StressStats& StudentWorld::getStressStats() const {
+	return m_stressStats;
+}
+
+void StudentWorld::resetStressStats() {
+	m_stressStats = StressStats();
+}
+
+const int OBS_BATCH = 64;	// must be a multiple of 4
+
+// computes the grid cell of the first n (a multiple of 4) gathered actors, -1 if off the road or screen
+static void binObservationsScalar(const float* xs, const float* ys, const int* chs, int* cells, int n) {
+	const float rowScale = static_cast<float>(OBS_ROWS) / VIEW_HEIGHT;
+	for (int k = 0; k < n; ++k) {
+		int lane = (xs[k] >= LEFT_MID_BOUND) + (xs[k] >= RIGHT_MID_BOUND);
+		bool inside = xs[k] >= LEFT_BOUND && xs[k] < RIGHT_BOUND && ys[k] >= 0 && ys[k] < VIEW_HEIGHT;
+		int row = static_cast<int>(ys[k] * rowScale);
+		cells[k] = inside ? (chs[k] * OBS_LANES + lane) * OBS_ROWS + row : -1;
+	}
+}
+
+#ifdef OBS_USE_SSE2
+// as binObservationsScalar, four actors at a time; xs, ys, chs and cells must be 16 byte aligned
+static void binObservationsSse2(const float* xs, const float* ys, const int* chs, int* cells, int n) {
+	const float rowScale = static_cast<float>(OBS_ROWS) / VIEW_HEIGHT;
+	const __m128 lb = _mm_set1_ps(LEFT_BOUND), lmb = _mm_set1_ps(LEFT_MID_BOUND);
+	const __m128 rmb = _mm_set1_ps(RIGHT_MID_BOUND), rb = _mm_set1_ps(RIGHT_BOUND);
+	const __m128 top = _mm_set1_ps(VIEW_HEIGHT), scale = _mm_set1_ps(rowScale);
+	const __m128 zero = _mm_setzero_ps();
+	for (int k = 0; k < n; k += 4) {
+		__m128 x = _mm_load_ps(xs + k);
+		__m128 y = _mm_load_ps(ys + k);
+
+		// comparison masks are all ones (-1) when true, so subtracting them counts the lane boundaries passed
+		__m128i lane = _mm_sub_epi32(_mm_setzero_si128(), _mm_add_epi32(
+			_mm_castps_si128(_mm_cmpge_ps(x, lmb)), _mm_castps_si128(_mm_cmpge_ps(x, rmb))));
+		__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(x, lb), _mm_cmplt_ps(x, rb)),
+			_mm_and_ps(_mm_cmpge_ps(y, zero), _mm_cmplt_ps(y, top)));
+		__m128i row = _mm_cvttps_epi32(_mm_mul_ps(y, scale));
+		__m128i ch = _mm_load_si128(reinterpret_cast<const __m128i*>(chs + k));
+
+		// cell = (ch * OBS_LANES + lane) * OBS_ROWS + row
+		__m128i cell = _mm_add_epi32(_mm_add_epi32(ch, _mm_add_epi32(ch, ch)), lane);
+		cell = _mm_add_epi32(_mm_slli_epi32(cell, 5), row);
+		__m128i in = _mm_castps_si128(inside);
+		cell = _mm_or_si128(_mm_and_si128(in, cell), _mm_andnot_si128(in, _mm_set1_epi32(-1)));
+		_mm_store_si128(reinterpret_cast<__m128i*>(cells + k), cell);
+	}
+}
+#endif
+
+static void binObservations(const float* xs, const float* ys, const int* chs, int* cells, int n) {
+#ifdef OBS_USE_SSE2
+	binObservationsSse2(xs, ys, chs, cells, n);
+#else
+	binObservationsScalar(xs, ys, chs, cells, n);
+#endif
+}
+
+bool checkObservationBinning(int n) {
+	// the road's and screen's edges, and either side of them, then random positions on and around the road
+	const float edgeXs[] = { LEFT_BOUND, LEFT_MID_BOUND, RIGHT_MID_BOUND, RIGHT_BOUND };
+	const float edgeYs[] = { 0, VIEW_HEIGHT };
+	alignas(16) float xs[OBS_BATCH], ys[OBS_BATCH];
+	alignas(16) int chs[OBS_BATCH], sse[OBS_BATCH], scalar[OBS_BATCH];
+	int edge = 0;
+	for (int done = 0; done < n; done += OBS_BATCH) {
+		for (int k = 0; k < OBS_BATCH; ++k, ++edge) {
+			// each x edge, half a pixel either side and on it, against each y edge the same way
+			if (edge < 4 * 3 * 2 * 3) {
+				xs[k] = edgeXs[edge % 4] + (edge / 4 % 3 - 1) * 0.5f;
+				ys[k] = edgeYs[edge / 12 % 2] + (edge / 24 - 1) * 0.5f;
+			}
+			else {
+				xs[k] = static_cast<float>(randInt(0, VIEW_WIDTH * 4)) / 4;
+				ys[k] = static_cast<float>(randInt(-VIEW_HEIGHT / 8, VIEW_HEIGHT * 9 / 8) * 4 + randInt(0, 3)) / 4;
+			}
+			chs[k] = randInt(0, OBS_NUM_CHANNELS - 1);
+		}
+		binObservationsScalar(xs, ys, chs, scalar, OBS_BATCH);
+#ifdef OBS_USE_SSE2
+		binObservationsSse2(xs, ys, chs, sse, OBS_BATCH);
+#else
+		copy(scalar, scalar + OBS_BATCH, sse);
+#endif
+		if (!equal(scalar, scalar + OBS_BATCH, sse))
+			return false;
 	}
+	return true;
+}
 
-	return false;
+void StudentWorld::getObservation(float* out) const {
+	static_assert(OBS_ROWS == 32, "binObservations shifts by 5 to multiply by OBS_ROWS");
+
+	fill(out, out + OBS_GRID_SIZE, 0.0f);
+
+	// gather observed actors into fixed size batches, bin each batch at once, then mark the cells
+	alignas(16) float xs[OBS_BATCH], ys[OBS_BATCH];
+	alignas(16) int chs[OBS_BATCH], cells[OBS_BATCH];
+	int n = 0;
+	auto flush = [&]() {
+		// pad to a multiple of 4 with off screen entries
+		int padded = (n + 3) & ~3;
+		for (int k = n; k < padded; ++k) {
+			xs[k] = 0;
+			ys[k] = -1;
+			chs[k] = 0;
+		}
+		binObservations(xs, ys, chs, cells, padded);
+		for (int k = 0; k < n; ++k) {
+			if (cells[k] >= 0)
+				out[cells[k]] = 1.0f;
+		}
+		n = 0;
+	};
+
+	// each observed type's collection at once, so its channel is known without asking each actor
+	const float pixelsPerFixed = 1.0f / FIXED_ONE;
+	auto gather = [&](const auto& actors, int ch) {
+		for (const Actor* a : actors) {
+			xs[n] = fixedXOf(a) * pixelsPerFixed;
+			ys[n] = fixedYOf(a) * pixelsPerFixed;
+			chs[n] = ch;
+			if (++n == OBS_BATCH)
+				flush();
+		}
+	};
+	gather(m_cabs, OBS_CAB);
+	gather(m_zombies, OBS_ZOMBIE);
+	gather(m_humans, OBS_HUMAN);
+	gather(m_heals, OBS_GOODIE);
+	gather(m_holyWaters, OBS_GOODIE);
+	gather(m_lostSouls, OBS_GOODIE);
+	gather(m_oils, OBS_OIL);
+	gather(m_sprays, OBS_SPRAY);
+	if (n > 0)
+		flush();
+
+	// racer scalars
+	float* scalars = out + OBS_GRID_SIZE;
+	scalars[OBS_RACER_X] = static_cast<float>((m_racer->getX() - ROAD_CENTER) / (ROAD_WIDTH / 2.0));
+	scalars[OBS_RACER_SPEED] = static_cast<float>(m_racer->getSpeedY() / 5.0);
+	scalars[OBS_RACER_DIR] = static_cast<float>((m_racer->getDirection() - 90) / 30.0);
+	scalars[OBS_RACER_HP] = static_cast<float>(m_racer->getHP() / 100.0);
+	scalars[OBS_RACER_SPRAYS] = static_cast<float>(m_racer->getSprays() / 100.0);
+}
+
+// how far an actor dx, dy from the racer is for the planner, squared; the racer drives up the screen, so actors
+// behind it count for twice as far as those ahead
+static float planDistance(float dx, float dy) {
+	if (dy < 0)
+		dy *= 2;
+	return dx * dx + dy * dy;
+}
+
+void StudentWorld::getPlanState(PlanState& s) const {
+	s.x = static_cast<float>(m_racer->getX());
+	s.y = static_cast<float>(m_racer->getY());
+	s.speedY = static_cast<float>(m_racer->getSpeedY());
+	s.dir = m_racer->getDirection();
+	s.hp = m_racer->getHP();
+	s.sprays = m_racer->getSprays();
+	s.souls = 0;
+	s.dead = false;
+	s.value = 0;
+	s.firstChoice = 0;
+	s.numHazards = 0;
+
+	// the PLAN_MAX_HAZARDS actors nearest the racer, by planDistance(), kept in s.hazards as they are found
+	// farthest holds their slots as a heap, the farthest first, so a nearer actor replaces that one
+	const float racerX = s.x;
+	const float racerY = s.y;
+	float distance[PLAN_MAX_HAZARDS];
+	int farthest[PLAN_MAX_HAZARDS];
+	auto fartherSlot = [&](int i, int j) { return distance[i] < distance[j]; };
+
+	forEachActor([&](const Actor* a) {
+		int kind;
+		switch (a->getImageID()) {
+		case IID_HUMAN_PED:				kind = PLAN_HUMAN;		break;
+		case IID_ZOMBIE_PED:			kind = PLAN_ZOMBIE;		break;
+		case IID_ZOMBIE_CAB:			kind = PLAN_CAB;		break;
+		case IID_OIL_SLICK:				kind = PLAN_OIL;		break;
+		case IID_HEAL_GOODIE:			kind = PLAN_HEAL;		break;
+		case IID_HOLY_WATER_GOODIE:		kind = PLAN_HOLY_WATER;	break;
+		case IID_SOUL_GOODIE:			kind = PLAN_SOUL;		break;
+		default:						return;
+		}
+
+		const float x = static_cast<float>(fromFixed(fixedXOf(a)));
+		const float y = static_cast<float>(fromFixed(fixedYOf(a)));
+		const float d = planDistance(x - racerX, y - racerY);
+		int slot;
+		if (s.numHazards < PLAN_MAX_HAZARDS) {
+			slot = s.numHazards++;
+			farthest[slot] = slot;
+			distance[slot] = d;
+			push_heap(farthest, farthest + s.numHazards, fartherSlot);
+		}
+		else if (d < distance[farthest[0]]) {
+			pop_heap(farthest, farthest + PLAN_MAX_HAZARDS, fartherSlot);
+			slot = farthest[PLAN_MAX_HAZARDS - 1];
+			distance[slot] = d;
+			push_heap(farthest, farthest + PLAN_MAX_HAZARDS, fartherSlot);
+		}
+		else
+			return;
+
+		PlanHazard& h = s.hazards[slot];
+		h.x = x;
+		h.y = y;
+		h.speedX = static_cast<float>(a->getSpeedX());
+		h.speedY = static_cast<float>(a->getSpeedY());
+		h.radius = static_cast<float>(a->getRadius());
+		h.kind = static_cast<signed char>(kind);
+		h.hp = static_cast<signed char>(a->getHP());
+	});
 }
 
 // private
+bool StudentWorld::racerInPlay() {
+	if (m_stress && !m_racer->alive()) {
+		m_racer->revive(RACER_MAX_HP);
+		++m_stressStats.racerDeaths;
+	}
+	return m_racer->alive();
+}
+
+void StudentWorld::sustainScenario() {
+	// dead actors have already been removed by move()
+	int humans = static_cast<int>(m_humans.size());
+	int zombies = static_cast<int>(m_zombies.size());
+	int cabs = static_cast<int>(m_cabs.size());
+	int goodies = static_cast<int>(m_oils.size() + m_heals.size() + m_holyWaters.size());
+	int sprays = static_cast<int>(m_sprays.size());
+
+	StressTimer timer(true, m_stressStats.spawnNs, m_stressStats.spawns);
+	int before = getNumActors();
+	for (; humans < m_scenario.humans; ++humans)
+		addActor(new Human(randInt(LEFT_BOUND, RIGHT_BOUND), randInt(0, VIEW_HEIGHT)));
+	for (; zombies < m_scenario.zombies; ++zombies)
+		addActor(new Zombie(randInt(LEFT_BOUND, RIGHT_BOUND), randInt(0, VIEW_HEIGHT)));
+	for (; cabs < m_scenario.cabs; ++cabs) {
+		int lane = randInt(LEFT_LANE, RIGHT_LANE);
+		double x = (lane == LEFT_LANE ? ROAD_LEFT : (lane == MIDDLE_LANE ? ROAD_CENTER : ROAD_RIGHT));
+		addActor(new Cab(x, randInt(0, VIEW_HEIGHT), m_racer->getSpeedY() + randInt(-4, 4), lane));
+	}
+	for (; goodies < m_scenario.goodies; ++goodies) {
+		double x = randInt(LEFT_BOUND, RIGHT_BOUND), y = randInt(0, VIEW_HEIGHT);
+		switch (goodies % 3) {
+		case 0:	addActor(new Oil(x, y));			break;
+		case 1:	addActor(new Heal(x, y));			break;
+		case 2:	addActor(new HolyWater(x, y));	break;
+		}
+	}
+	for (; sprays < m_scenario.sprays; ++sprays)
+		addActor(new Spray(randInt(LEFT_BOUND, RIGHT_BOUND), randInt(0, VIEW_HEIGHT), 90));
+	timer.setItems(getNumActors() - before);
+}
+
+template <class T>
+void StudentWorld::updateAll(vector<T*>& actors) {
+	for (size_t k = 0; k < actors.size(); ++k) {
+		T* a = actors[k];
+		if (a->alive())
+			a->T::doSomething(*this);
+	}
+}
+
+template <class T>
+void StudentWorld::collectTouching(vector<T*>& goodies) {
+	for (size_t k = 0; k < goodies.size(); ++k) {
+		T* g = goodies[k];
+		if (g->alive() && m_motion.isTouchingRacer(g->getMotionSlot()))
+			g->T::doSomething(*this);
+	}
+}
+
+template <class T>
+void StudentWorld::removeDead(vector<T*>& actors) {
+	size_t kept = 0;
+	for (size_t k = 0; k < actors.size(); ++k) {
+		T* a = actors[k];
+		if (a->alive()) {
+			actors[kept++] = a;
+			continue;
+		}
+
+		logEvent(GAMEPLAY_DEATH, a, a->getDeathCause());
+		StressTimer timer(m_stress, m_stressStats.destroyNs, m_stressStats.destroys);
+		if (a->getMotionSlot() != -1)
+			m_motion.remove(a->getMotionSlot());
+		delete a;
+	}
+	actors.resize(kept);
+}
+
+// findInteracting()'s pass over one collection
+template <CollisionCategory C, class T, class F>
+static bool findInCollection(const vector<T*>& actors, F& f) {
+	if (!collides(C, ActorTraits<T>::category))
+		return false;
+
+	for (size_t k = 0; k < actors.size(); ++k) {
+		if (f(actors[k]))
+			return true;
+	}
+	return false;
+}
+
+template <CollisionCategory C, class F>
+bool StudentWorld::findInteracting(F f) const {
+	return findInCollection<C>(m_humans, f) || findInCollection<C>(m_zombies, f) || findInCollection<C>(m_cabs, f)
+		|| findInCollection<C>(m_oils, f) || findInCollection<C>(m_heals, f) || findInCollection<C>(m_holyWaters, f)
+		|| findInCollection<C>(m_lostSouls, f) || findInCollection<C>(m_sprays, f);
+}
+
+void StudentWorld::applyEvents() {
+	// indexed, as applying an event may post more
+	for (int k = 0; k < m_events.size(); ++k) {
+		Event e = m_events[k];
+		switch (e.type) {
+		case EVENT_DAMAGE:
+			// e.g. two sprays hitting a Zombie in the same tick only kill it once
+			if (e.actor->alive())
+				e.actor->damage(e.value, *this);
+			break;
+		case EVENT_HEAL:
+			// as damage of minus the heal, as it always was, so the log shows it
+			if (m_racer->alive())
+				m_racer->damage(m_racer->getHP() - min(m_racer->getHP() + e.value, RACER_MAX_HP), *this);
+			break;
+		case EVENT_KILL:
+			e.actor->kill(DEATH_HIT);
+			break;
+		case EVENT_SCORE:
+			logEvent(GAMEPLAY_SCORE, m_racer, e.value);
+			increaseScore(e.value);
+			break;
+		case EVENT_SOUND:
+			playSound(e.value);
+			break;
+		case EVENT_SPAWN:
+			addActor(e.actor);
+			break;
+		case EVENT_SOUL_SAVED:
+			m_souls += e.value;
+			logEvent(GAMEPLAY_SOUL_SAVED, m_racer, m_souls);
+			break;
+		case EVENT_SPIN:
+			m_racer->setDirection(m_racer->getDirection() + e.value);
+			break;
+		case EVENT_SPRAYS:
+			m_racer->setSprays(m_racer->getSprays() + e.value);
+			break;
+		}
+	}
+	m_events.clear();
+}
+
+void StudentWorld::countLiveActors() const {
+	Metrics& m = metrics();
+	m.setLiveActors(IID_GHOST_RACER, m_racer->alive() ? 1 : 0);
+	m.setLiveActors(IID_HUMAN_PED, static_cast<int>(m_humans.size()));
+	m.setLiveActors(IID_ZOMBIE_PED, static_cast<int>(m_zombies.size()));
+	m.setLiveActors(IID_ZOMBIE_CAB, static_cast<int>(m_cabs.size()));
+	m.setLiveActors(IID_OIL_SLICK, static_cast<int>(m_oils.size()));
+	m.setLiveActors(IID_HEAL_GOODIE, static_cast<int>(m_heals.size()));
+	m.setLiveActors(IID_HOLY_WATER_GOODIE, static_cast<int>(m_holyWaters.size()));
+	m.setLiveActors(IID_SOUL_GOODIE, static_cast<int>(m_lostSouls.size()));
+	m.setLiveActors(IID_HOLY_WATER_PROJECTILE, static_cast<int>(m_sprays.size()));
+}
+
+template <class F>
+void StudentWorld::forEachActor(F f) const {
+	for_each(m_humans.begin(), m_humans.end(), f);
+	for_each(m_zombies.begin(), m_zombies.end(), f);
+	for_each(m_cabs.begin(), m_cabs.end(), f);
+	for_each(m_oils.begin(), m_oils.end(), f);
+	for_each(m_heals.begin(), m_heals.end(), f);
+	for_each(m_holyWaters.begin(), m_holyWaters.end(), f);
+	for_each(m_lostSouls.begin(), m_lostSouls.end(), f);
+	for_each(m_sprays.begin(), m_sprays.end(), f);
+}
+
+::fixed StudentWorld::fixedXOf(const Actor* a) const {
+	return a->getMotionSlot() != -1 ? m_motion.getX(a->getMotionSlot()) : a->getFixedX();
+}
+
+::fixed StudentWorld::fixedYOf(const Actor* a) const {
+	return a->getMotionSlot() != -1 ? m_motion.getY(a->getMotionSlot()) : a->getFixedY();
+}
+
 bool StudentWorld::inLane(int lane, const Actor* a) const {
 	return ((lane == LEFT_LANE && a->getX() >= LEFT_BOUND && a->getX() < LEFT_MID_BOUND)
 		|| (lane == MIDDLE_LANE && a->getX() >= LEFT_MID_BOUND && a->getX() < RIGHT_MID_BOUND)
@@ -3,23 +3,68 @@
 
 #include "GameWorld.h"
 #include "GameConstants.h"
+#include "Autopilot.h"
+#include "LevelData.h"
+#include "MotionKernel.h"
+#include "EventBuffer.h"
+#include "GameplayLog.h"
+#include "Collision.h"
 
 #include <string>
-#include <list>
+#include <vector>
 
 // Students:  Add code to this file, StudentWorld.cpp, Actor.h, and Actor.cpp
 
 // constants
-const int LEFT_BOUND = ROAD_CENTER - ROAD_WIDTH / 2;       // pos of left boundary
-const int RIGHT_BOUND = ROAD_CENTER + ROAD_WIDTH / 2;      // pos of right boundary
-const int LEFT_MID_BOUND = LEFT_BOUND + ROAD_WIDTH / 3;    // pos of left middle boundary
-const int RIGHT_MID_BOUND = RIGHT_BOUND - ROAD_WIDTH / 3;  // pos of right middle boundary
-
 const int ROAD_LEFT = ROAD_CENTER - ROAD_WIDTH / 3.0;
 const int ROAD_RIGHT = ROAD_CENTER + ROAD_WIDTH / 3.0;
 
+// observation grid layout: OBS_NUM_CHANNELS planes of OBS_LANES x OBS_ROWS cells,
+// followed by OBS_NUM_SCALARS racer scalars
+const int OBS_LANES = 3;
+const int OBS_ROWS = 32;
+enum ObsChannel { OBS_CAB, OBS_ZOMBIE, OBS_HUMAN, OBS_GOODIE, OBS_OIL, OBS_SPRAY, OBS_NUM_CHANNELS };
+enum ObsScalar { OBS_RACER_X, OBS_RACER_SPEED, OBS_RACER_DIR, OBS_RACER_HP, OBS_RACER_SPRAYS, OBS_NUM_SCALARS };
+const int OBS_GRID_SIZE = OBS_NUM_CHANNELS * OBS_LANES * OBS_ROWS;
+const int OBS_SIZE = OBS_GRID_SIZE + OBS_NUM_SCALARS;
+
+// bins at least n positions, the road's and screen's edges first, with both the SSE2 and the scalar binning
+// returns whether they agree on every cell (trivially, where SSE2 isn't available)
+bool checkObservationBinning(int n);
+
+// target number of each actor type a stress scenario keeps alive
+// goodies alternate between Oil Slicks, Healing Goodies, and Holy Water Goodies
+struct StressScenario {
+    int humans;
+    int zombies;
+    int cabs;
+    int goodies;
+    int sprays;
+};
+
+// where a stress scenario's ticks went, accumulated until resetStressStats()
+struct StressStats {
+    double cabCheckNs;      // in checkCabFrontOrBack
+    double sprayCheckNs;    // in activatedSpray
+    double spawnNs;         // constructing scenario actors, including linking them into their depth list
+    double destroyNs;       // deleting dead actors, including unlinking them from their depth list
+    long long cabChecks;
+    long long sprayChecks;
+    long long spawns;
+    long long destroys;
+    long long racerDeaths;  // times the racer was revived
+};
+
 class Actor;
 class GhostRacer;
+class Human;
+class Zombie;
+class Cab;
+class Oil;
+class Heal;
+class HolyWater;
+class Soul;
+class Spray;
 
 class StudentWorld : public GameWorld
 {
@@ -30,10 +75,29 @@ public:
     virtual int move();
     virtual void cleanUp();
     void addActor(Actor* a);
-    void savedSoul();
+
+    // where actors post what they do to anything but themselves, applied at the end of move()
+    EventBuffer& events();
+
+    // records type at a's position in the gameplay log, stamped with this tick, if the log is open
+    // spawns and deaths are counted in metrics() too
+    void logEvent(GameplayEventType type, const Actor* a, int value);
+
+    // racer's input for this tick, from the keyboard or from the autopilot if it's on, one key a call
+    // until the tick has had all it may take; TAB toggles the autopilot
+    bool getInput(int& value);
+    void setAutopilot(bool on);
 
     // getters
     GhostRacer* getRacer() const;
+    virtual double getRoadScroll() const;
+    virtual void syncDrawnPositions();
+
+    // spawn rates, cab speeds, soul target, bonus and drop odds of the current level
+    const LevelDef& getLevelDef() const;
+
+    // number of actors in the world, not counting the racer
+    int getNumActors() const;
 
     // returns -1 if neither, 0 if collidable actor in front of cab within 96 pixels, 1 if behind cab within 96 pixels
     int checkCabFrontOrBack(int lane, const Actor* a) const;
@@ -41,19 +105,95 @@ public:
     // returns true if spray is activated, attempts to damage other actor by 1, and kills spray
     bool activatedSpray(Actor* a);
 
+    // rasterises the current tick into out, which must hold OBS_SIZE floats
+    // grid cells are 1 if an actor of that channel's type is in the cell, 0 otherwise
+    // scalars are the racer's state, normalized to roughly [-1, 1]
+    void getObservation(float* out) const;
+
+    // fills s with the current tick's racer and the PLAN_MAX_HAZARDS actors nearest it, as the autopilot's search root
+    void getPlanState(PlanState& s) const;
+
+    // puts the world in a stress scenario: init() pre-populates the targets, move() tops them back up
+    // every tick, and the racer is revived instead of dying so every tick runs the whole actor loop
+    void setScenario(const StressScenario& scenario);
+    const StressStats& getStressStats() const;
+    void resetStressStats();
+
 private:
     bool inLane(int lane, const Actor* a) const;
 
-    GhostRacer* m_racer;
-    std::list<Actor*> m_actors;
+    // a's position: the MotionKernel's for the actors it moves, whose GraphObjects are only moved for drawing
+    fixed fixedXOf(const Actor* a) const;
+    fixed fixedYOf(const Actor* a) const;
 
-    int m_yellow;   // N, number of yellow borders
-    int m_white;    // M, number of white borders
+    // false if the racer died, revives it instead in stress scenarios
+    bool racerInPlay();
 
-    double m_lastWhiteY;
+    // adds scenario actors at random positions on the road until every type is at its target
+    void sustainScenario();
+
+    // runs doSomething() on each living actor in actors, calling T's own version directly
+    template <class T>
+    void updateAll(std::vector<T*>& actors);
+
+    // runs doSomething() on each living Goodie in goodies that the MotionKernel found touching the racer
+    template <class T>
+    void collectTouching(std::vector<T*>& goodies);
+
+    // deletes the dead actors in actors, keeping the living ones in order
+    template <class T>
+    void removeDead(std::vector<T*>& actors);
+
+    // calls f on each actor of a category that actors of category C look for (see COLLISION_MATRIX), until f returns true
+    // collections of other categories are skipped without being looked at
+    // returns true if f did
+    template <CollisionCategory C, class F>
+    bool findInteracting(F f) const;
+
+    // calls f on every actor in the world except the racer
+    template <class F>
+    void forEachActor(F f) const;
+
+    // applies and clears the tick's events, in the order they were posted
+    void applyEvents();
+
+    // sets metrics()'s live actor gauges from the collections
+    void countLiveActors() const;
+
+    GhostRacer* m_racer;
+
+    // actors are kept in one collection per type, so each type's update loop calls its doSomething() directly
+    std::vector<Human*> m_humans;
+    std::vector<Zombie*> m_zombies;
+    std::vector<Cab*> m_cabs;
+    std::vector<Oil*> m_oils;
+    std::vector<Heal*> m_heals;
+    std::vector<HolyWater*> m_holyWaters;
+    std::vector<Soul*> m_lostSouls;
+    std::vector<Spray*> m_sprays;
+    MotionKernel m_motion;  // moves the actors that only scroll with the road (Goodies)
+    EventBuffer m_events;
+
+    // how far the road's lines have scrolled down since init(), modulo ROAD_TILE_HEIGHT
+    // the lines are drawn as one background layer rather than as Border Line actors
+    fixed m_roadScroll;
 
     int m_souls;
     int m_bonus;
+    unsigned int m_ticks;   // moves since construction, for the gameplay log
+    std::string m_statusText;   // reused every tick
+
+    bool m_levelsLoaded;
+    std::vector<LevelDef> m_levelDefs;  // levels from levels.txt, parsed on the first init()
+    LevelDef m_levelDef;                // current level's definition
+
+    Autopilot m_autopilot;
+    bool m_autopilotOn;
+    bool m_autopilotMoved;      // this tick
+
+    bool m_stress;
+    StressScenario m_scenario;
+    mutable StressStats m_stressStats;  // also updated by the const checkCabFrontOrBack
 };
 
 #endif // STUDENTWORLD_H_
@@ -0,0 +1,181 @@
+#include "TextAtlas.h"
+#include <algorithm>
+#include <cmath>
+using namespace std;
+
+  // GLUT_STROKE_ROMAN's glyphs rise up to 119.05 units above the baseline and drop 33.33 below it
+static const double STROKE_ASCENT = 119.05;
+static const double STROKE_DESCENT = 33.33;
+
+  // atlas layout: 16 x 6 cells, each big enough for the widest glyph at PIXELS_PER_UNIT
+static const int ATLAS_COLUMNS = 16;
+static const int ATLAS_ROWS = 6;
+static const int CELL_WIDTH = 24;
+static const int CELL_HEIGHT = 32;
+static const int CELL_PADDING = 1;		// pixels kept clear around the glyph so neighbours don't bleed in when filtered
+static const double PIXELS_PER_UNIT = (CELL_HEIGHT - 2 * CELL_PADDING) / (STROKE_ASCENT + STROKE_DESCENT);
+static const int ATLAS_WIDTH = ATLAS_COLUMNS * CELL_WIDTH;
+static const int ATLAS_HEIGHT = ATLAS_ROWS * CELL_HEIGHT;
+
+TextAtlas::TextAtlas()
+ : m_texture(0), m_tried(false)
+{
+	for (int k = 0; k < NUM_GLYPHS; k++)
+		m_advance[k] = 0;
+	for (int k = 0; k < NUM_TEXT_SLOTS; k++)
+		m_layouts[k].scaleDown = 0;
+}
+
+TextAtlas::~TextAtlas()
+{
+	if (m_texture != 0)
+		glDeleteTextures(1, &m_texture);
+}
+
+bool TextAtlas::build()
+{
+	if (m_tried)
+		return isBuilt();
+	m_tried = true;
+
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	if (viewport[2] < ATLAS_WIDTH  ||  viewport[3] < ATLAS_HEIGHT)
+		return false;
+
+	  // draw every glyph in white on transparent black, one per cell, with pixels as the units
+	glPushAttrib(GL_ALL_ATTRIB_BITS);
+	glMatrixMode(GL_PROJECTION);
+	glPushMatrix();
+	glLoadIdentity();
+	glOrtho(0, viewport[2], 0, viewport[3], -1, 1);
+	glMatrixMode(GL_MODELVIEW);
+	glPushMatrix();
+	glLoadIdentity();
+
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_TEXTURE_2D);
+	glDisable(GL_BLEND);
+	glClearColor(0, 0, 0, 0);
+	glClear(GL_COLOR_BUFFER_BIT);
+	glColor4f(1, 1, 1, 1);
+	glLineWidth(1);
+
+	for (int k = 0; k < NUM_GLYPHS; k++)
+	{
+		int column = k % ATLAS_COLUMNS;
+		int row = k / ATLAS_COLUMNS;
+		m_advance[k] = static_cast<GLfloat>(glutStrokeWidth(GLUT_STROKE_ROMAN, FIRST_GLYPH + k));
+
+		glPushMatrix();
+		glTranslated(column * CELL_WIDTH + CELL_PADDING, row * CELL_HEIGHT + CELL_PADDING + STROKE_DESCENT * PIXELS_PER_UNIT, 0);
+		glScaled(PIXELS_PER_UNIT, PIXELS_PER_UNIT, 1);
+		glutStrokeCharacter(GLUT_STROKE_ROMAN, FIRST_GLYPH + k);
+		glPopMatrix();
+	}
+
+	  // read it back, bottom row first as a texture wants it, and keep the coverage as alpha under white
+	vector<unsigned char> pixels(ATLAS_WIDTH * ATLAS_HEIGHT * 4);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	glReadPixels(0, 0, ATLAS_WIDTH, ATLAS_HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	for (size_t k = 0; k < pixels.size(); k += 4)
+	{
+		pixels[k + 3] = pixels[k];
+		pixels[k] = pixels[k + 1] = pixels[k + 2] = 255;
+	}
+
+	glMatrixMode(GL_PROJECTION);
+	glPopMatrix();
+	glMatrixMode(GL_MODELVIEW);
+	glPopMatrix();
+	glPopAttrib();
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+	glGenTextures(1, &m_texture);
+	glBindTexture(GL_TEXTURE_2D, m_texture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, static_cast<GLfloat>(GL_CLAMP));
+	glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, static_cast<GLfloat>(GL_CLAMP));
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, 4, ATLAS_WIDTH, ATLAS_HEIGHT, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+	return true;
+}
+
+void TextAtlas::layOut(Layout& layout, const string& str, double scaleDown)
+{
+	layout.text = str;
+	layout.scaleDown = scaleDown;
+	layout.vertices.clear();
+
+	double length = 0;
+	for (char c : str)
+	{
+		int k = static_cast<unsigned char>(c) - FIRST_GLYPH;
+		if (k >= 0  &&  k < NUM_GLYPHS)
+			length += m_advance[k];
+	}
+
+	  // a cell's corners relative to the pen on the baseline, in window units
+	const double unit = 1 / scaleDown;
+	const double left = -CELL_PADDING / PIXELS_PER_UNIT * unit;
+	const double bottom = -(CELL_PADDING / PIXELS_PER_UNIT + STROKE_DESCENT) * unit;
+	const double width = CELL_WIDTH / PIXELS_PER_UNIT * unit;
+	const double height = CELL_HEIGHT / PIXELS_PER_UNIT * unit;
+
+	double pen = -length / 2 * unit;
+	for (char c : str)
+	{
+		int k = static_cast<unsigned char>(c) - FIRST_GLYPH;
+		if (k < 0  ||  k >= NUM_GLYPHS)
+			continue;
+
+		GLfloat x1 = static_cast<GLfloat>(pen + left);
+		GLfloat y1 = static_cast<GLfloat>(bottom);
+		GLfloat x2 = static_cast<GLfloat>(pen + left + width);
+		GLfloat y2 = static_cast<GLfloat>(bottom + height);
+		GLfloat u1 = static_cast<GLfloat>(k % ATLAS_COLUMNS) / ATLAS_COLUMNS;
+		GLfloat v1 = static_cast<GLfloat>(k / ATLAS_COLUMNS) / ATLAS_ROWS;
+		GLfloat u2 = u1 + 1.0f / ATLAS_COLUMNS;
+		GLfloat v2 = v1 + 1.0f / ATLAS_ROWS;
+		const GLfloat quad[16] = {
+			x1, y1, u1, v1,
+			x2, y1, u2, v1,
+			x2, y2, u2, v2,
+			x1, y2, u1, v2
+		};
+		layout.vertices.insert(layout.vertices.end(), quad, quad + 16);
+		pen += m_advance[k] * unit;
+	}
+}
+
+void TextAtlas::drawCentered(TextSlot slot, const string& str, double y, double z, double scaleDown)
+{
+	Layout& layout = m_layouts[slot];
+	if (layout.text != str  ||  layout.scaleDown != scaleDown)
+		layOut(layout, str, scaleDown);
+	if (layout.vertices.empty())
+		return;
+
+	glPushMatrix();
+	glLoadIdentity();
+	glTranslated(0, y, z);
+	glPushAttrib(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_ENABLE_BIT);
+	glEnable(GL_TEXTURE_2D);
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glBindTexture(GL_TEXTURE_2D, m_texture);
+	glTexEnvf(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+	glPushClientAttrib(GL_CLIENT_VERTEX_ARRAY_BIT);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 4 * sizeof(GLfloat), layout.vertices.data());
+	glTexCoordPointer(2, GL_FLOAT, 4 * sizeof(GLfloat), layout.vertices.data() + 2);
+	glDrawArrays(GL_QUADS, 0, static_cast<GLsizei>(layout.vertices.size() / 4));
+	glPopClientAttrib();
+
+	glPopAttrib();
+	glPopMatrix();
+}
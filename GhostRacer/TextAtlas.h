@@ -0,0 +1,58 @@
+#ifndef TEXTATLAS_H_
+#define TEXTATLAS_H_
+
+#include "freeglut.h"
+#include <string>
+#include <vector>
+
+  // HUD and prompt text drawn from a glyph atlas instead of stroked a line strip at a time
+  // the printable characters of GLUT_STROKE_ROMAN are rasterised into one texture the first time text is drawn,
+  // and each string is laid out into textured quads that are kept until that string changes,
+  // so drawing a string is one glDrawArrays() call
+
+enum TextSlot { TEXT_HUD, TEXT_PROMPT_MAIN, TEXT_PROMPT_SECOND, TEXT_LATENCY, TEXT_TURBO, TEXT_ALLOCS, NUM_TEXT_SLOTS };
+
+class TextAtlas
+{
+  public:
+	TextAtlas();
+	~TextAtlas();
+
+	  // Rasterise the font through the back buffer, so call it where the frame is about to be cleared anyway
+	  // only the first call does anything; returns false if it couldn't, in which case text should be stroked as before
+	bool build();
+
+	bool isBuilt() const
+	{
+		return m_texture != 0;
+	}
+
+	  // Draw str centred across the window at height y and depth z, in the current color and at the size
+	  // the stroke font is drawn when scaled down by scaleDown
+	  // slot says which cached layout to reuse, and str is laid out again only if it differs from that slot's last one
+	void drawCentered(TextSlot slot, const std::string& str, double y, double z, double scaleDown);
+
+  private:
+	  // Prevent copying or assigning TextAtlases, which own a texture
+	TextAtlas(const TextAtlas&);
+	TextAtlas& operator=(const TextAtlas&);
+
+	struct Layout
+	{
+		std::string text;
+		double scaleDown;
+		std::vector<GLfloat> vertices;	// x, y, u, v for each corner of each glyph's quad
+	};
+
+	void layOut(Layout& layout, const std::string& str, double scaleDown);
+
+	static const int FIRST_GLYPH = ' ';
+	static const int NUM_GLYPHS = '~' - ' ' + 1;
+
+	GLuint	m_texture;
+	bool	m_tried;
+	GLfloat	m_advance[NUM_GLYPHS];		// how far each glyph moves the pen, in stroke units
+	Layout	m_layouts[NUM_TEXT_SLOTS];
+};
+
+#endif // TEXTATLAS_H_
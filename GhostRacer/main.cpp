@@ -1,4 +1,9 @@
 #include "GameController.h"
+#include "Benchmark.h"
+#include "GameplayLog.h"
+#include "Metrics.h"
+#include "AllocStats.h"
+#include "StudentWorld.h"
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -32,8 +37,28 @@ class GameWorld;
 
 GameWorld* createStudentWorld(string assetPath = "");
 
+static void printAllocReport()
+{
+    allocStats().printReport();
+}
+
 int main(int argc, char* argv[])
 {
+      // headless benchmark modes, which need neither a window nor the assets
+    if (argc >= 2  &&  string(argv[1]) == "-bench")
+        return runBenchmarks(argc >= 3 ? argv[2] : "bench.json");
+    if (argc >= 4  &&  string(argv[1]) == "-compare")
+        return compareBenchmarks(argv[2], argv[3]);
+    if (argc >= 4  &&  string(argv[1]) == "-logcsv")
+        return convertGameplayLog(argv[2], argv[3]);
+    if (argc >= 2  &&  string(argv[1]) == "-alloccheck")
+        return checkSteadyAllocs(argc >= 3 ? atoi(argv[2]) : 3000);
+    if (argc >= 7  &&  string(argv[1]) == "-stress")
+    {
+        StressScenario scenario = { atoi(argv[2]), atoi(argv[3]), atoi(argv[4]), atoi(argv[5]), atoi(argv[6]) };
+        return runStress(scenario, argc >= 8 ? atoi(argv[7]) : 100);
+    }
+
     string assetPath = assetDirectory;
     if (!assetPath.empty())
     {
@@ -55,6 +80,31 @@ int main(int argc, char* argv[])
 		}
 	}
 
+	  // "-log play.bin" records spawns, deaths, damage, score and levels in play, for "-logcsv play.bin play.csv"
+	  // "-metrics game.prom" rewrites live counters in Prometheus format every second, "-metrics :9100" serves them
+	  // "-allocs" shows the heap overlay, prints ticks that allocate once warm, and reports heap use on exit
+	for (int k = 1; k < argc; k++)
+	{
+		if (string(argv[k]) == "-allocs"  &&  !allocStats().isReporting())
+		{
+			allocStats().setReporting(true);
+			atexit(printAllocReport);
+		}
+	}
+	for (int k = 1; k + 1 < argc; k++)
+	{
+		if (string(argv[k]) == "-log"  &&  !gameplayLog().open(argv[k + 1]))
+			cout << "Cannot write the gameplay log to " << argv[k + 1] << endl;
+		if (string(argv[k]) == "-metrics"  &&  !metricsExporter().start(argv[k + 1]))
+			cout << "Cannot export metrics to " << argv[k + 1] << endl;
+	}
+
+	  // headless rendering and recording, which need the assets but not a window
+	if (argc >= 3  &&  string(argv[1]) == "-render")
+		return renderFrame(assetPath, argv[2], argc >= 4 ? atoi(argv[3]) : 0);
+	if (argc >= 4  &&  string(argv[1]) == "-record")
+		return recordRun(assetPath, argv[2], atoi(argv[3]));
+
 	srand(static_cast<unsigned int>(time(nullptr)));
 
 	GameWorld* gw = createStudentWorld(assetPath);